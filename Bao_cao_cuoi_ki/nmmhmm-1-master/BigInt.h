@@ -4,82 +4,332 @@
 #include <string>
 #include <sstream>
 #include <random>
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#if defined(_MSC_VER) && !defined(__SIZEOF_INT128__)
+#include <intrin.h>
+#endif
+
+//SSE2 is part of every x86-64 target, define NO_SIMD_HEX to force the scalar hex codec
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(NO_SIMD_HEX)
+#define SIMD_HEX
+#include <emmintrin.h>
+#endif
 
 #ifdef PARALLEL_PRIME_CHECK
-#include <thread>
-#include <atomic>
+#include "ThreadPool.h"
 #endif
 
+#include "FixedBigInt.h"
+
 using namespace std;
 
 #define IS_POSITIVE(n) ((n).sign == 0) //can be Zero
 
 #define IS_NEGATIVE(n) ((n).sign == 1) //can be Zero
 
+typedef uint64_t limb_t;
+
+//How many small primes isPrime tries before Miller-Rabin
+#ifndef SMALL_PRIME_COUNT
+#define SMALL_PRIME_COUNT 2048
+#endif
+
+//Operand sizes in limbs where operator* switches tiers, tune with bench.cpp
+#ifndef KARATSUBA_THRESHOLD
+#define KARATSUBA_THRESHOLD 64
+#endif
+
+#ifndef TOOM3_THRESHOLD
+#define TOOM3_THRESHOLD 192
+#endif
+
+//Below this many limbs toDecString peels 19 digits at a time instead of splitting
+#ifndef DEC_SPLIT_THRESHOLD
+#define DEC_SPLIT_THRESHOLD 16
+#endif
+
 class BigInt {
+	friend class DiscreteLog;
+
+public:
+	class Montgomery;
+	class Barrett;
+
+	//How powMod scans the exponent. FIXED_WINDOW reads the whole table on every
+	//multiplication so the memory access pattern does not depend on secret bits
+	enum ExpMode {
+		SLIDING_WINDOW,
+		FIXED_WINDOW
+	};
+
+	enum MulAlgorithm {
+		MUL_AUTO,
+		MUL_SCHOOLBOOK,
+		MUL_KARATSUBA,
+		MUL_TOOM3
+	};
+
 private:
-	vector<char> bits;
+	static constexpr int LIMB_BITS = 64;
+	static constexpr int LIMB_NIBBLES = LIMB_BITS / 4;
+	static constexpr int DEC_DIGITS = 19; //decimal digits per limb chunk
+	static constexpr limb_t DEC_CHUNK = 10000000000000000000ULL; //10^19
+
+	vector<limb_t> limbs; //little endian, never has leading zero limbs
 	bool sign = 0;
 
 private:
+	//Limb primitives
+	static limb_t addCarry(limb_t a, limb_t b, limb_t &carry) {
+		limb_t s = a + carry;
+		limb_t c = s < carry;
+		s += b;
+		carry = c | (s < b);
+		return s;
+	}
+
+	static limb_t subBorrow(limb_t a, limb_t b, limb_t &borrow) {
+		limb_t d = a - b;
+		limb_t c = a < b;
+		limb_t res = d - borrow;
+		borrow = c | (d < borrow);
+		return res;
+	}
+
+	//return low word of a * b + c + carry, high word goes to carry
+	static limb_t mulAdd(limb_t a, limb_t b, limb_t c, limb_t &carry) {
+#ifdef __SIZEOF_INT128__
+		unsigned __int128 t = (unsigned __int128)a * b + c + carry;
+		carry = (limb_t)(t >> 64);
+		return (limb_t)t;
+#else
+		limb_t hi;
+		limb_t lo = _umul128(a, b, &hi);
+		lo += c;
+		hi += lo < c;
+		lo += carry;
+		hi += lo < carry;
+		carry = hi;
+		return lo;
+#endif
+	}
+
+	//return (hi:lo) / d and put the remainder in rem, requires hi < d
+	static limb_t divWide(limb_t hi, limb_t lo, limb_t d, limb_t &rem) {
+#ifdef __SIZEOF_INT128__
+		unsigned __int128 n = ((unsigned __int128)hi << 64) | lo;
+		rem = (limb_t)(n % d);
+		return (limb_t)(n / d);
+#else
+		return _udiv128(hi, lo, d, &rem);
+#endif
+	}
+
+	static int countLeadingZeros(limb_t x) {
+		if (x == 0) return LIMB_BITS;
+#ifdef _MSC_VER
+		unsigned long idx;
+		_BitScanReverse64(&idx, x);
+		return LIMB_BITS - 1 - idx;
+#else
+		return __builtin_clzll(x);
+#endif
+	}
+
+	static int countTrailingZeros(limb_t x) {
+		if (x == 0) return LIMB_BITS;
+#ifdef _MSC_VER
+		unsigned long idx;
+		_BitScanForward64(&idx, x);
+		return idx;
+#else
+		return __builtin_ctzll(x);
+#endif
+	}
+
+	static int popCount(limb_t x) {
+#ifdef _MSC_VER
+		return (int)__popcnt64(x);
+#else
+		return __builtin_popcountll(x);
+#endif
+	}
+
 	void clean() {
-		while (!bits.empty() && bits.back() == 0) {
-			bits.pop_back();
+		while (!limbs.empty() && limbs.back() == 0) {
+			limbs.pop_back();
 		}
-		if (bits.size() == 0) sign = 0;
+		if (limbs.size() == 0) sign = 0;
+	}
+
+	//return count (<= 64) bits starting at index
+	limb_t getBits(int index, int count) const {
+		size_t w = index / LIMB_BITS;
+		int off = index % LIMB_BITS;
+		limb_t res = 0;
+		if (w < limbs.size()) res = limbs[w] >> off;
+		if (off && off + count > LIMB_BITS && w + 1 < limbs.size())
+			res |= limbs[w + 1] << (LIMB_BITS - off);
+		if (count < LIMB_BITS) res &= ((limb_t)1 << count) - 1;
+		return res;
+	}
+
+	void setBit(int index) {
+		size_t w = index / LIMB_BITS;
+		if (w >= limbs.size()) limbs.resize(w + 1);
+		limbs[w] |= (limb_t)1 << (index % LIMB_BITS);
 	}
 
 	void parseBinaryString(const string &bs) {
-		bits.resize(bs.length());
+		limbs.assign((bs.length() + LIMB_BITS - 1) / LIMB_BITS, 0);
 		for (int i = 0; i < bs.length(); i++) {
-			bits[i] = bs[i] - '0';
+			if (bs[i] == '1')
+				limbs[i / LIMB_BITS] |= (limb_t)1 << (i % LIMB_BITS);
 		}
 	}
 
-	void parseHexString(const string &hs) {
-		const bool tbl[16][4] = {
-			{0,0,0,0}, //0
-			{0,0,0,1}, //1
-			{0,0,1,0}, //2
-			{0,0,1,1}, //3
-			{0,1,0,0}, //4
-			{0,1,0,1}, //5
-			{0,1,1,0}, //6
-			{0,1,1,1}, //7
-			{1,0,0,0}, //8
-			{1,0,0,1}, //9
-			{1,0,1,0}, //A
-			{1,0,1,1}, //B
-			{1,1,0,0}, //C
-			{1,1,0,1}, //D
-			{1,1,1,0}, //E
-			{1,1,1,1}, //F
+	//Hex codec, a limb is 16 characters with the least significant nibble first.
+	//Anything other than 0-9 and A-F reads as 0
+	static limb_t hexValue(char c) {
+		static const struct Table {
+			unsigned char v[256] = {};
+			Table() {
+				for (int i = 0; i < 10; i++) v['0' + i] = i;
+				for (int i = 0; i < 6; i++) v['A' + i] = 10 + i;
+			}
+		} table;
+		return table.v[(unsigned char)c];
+	}
+
+	static limb_t hexToLimb(const char *s) {
+#ifdef SIMD_HEX
+		//map every byte to its nibble, bytes of 0x80 and up compare as negative and fail both ranges
+		const __m128i c = _mm_loadu_si128((const __m128i*)s);
+		const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+		const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('F' + 1)));
+		const __m128i v = _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+			_mm_and_si128(alpha, _mm_sub_epi8(c, _mm_set1_epi8('A' - 10))));
+
+		//each 16 bit lane holds lo | hi << 8, fold it to lo | hi << 4 and pack the lanes into bytes
+		const __m128i folded = _mm_and_si128(_mm_or_si128(v, _mm_srli_epi16(v, 4)), _mm_set1_epi16(0xFF));
+		return (limb_t)_mm_cvtsi128_si64(_mm_packus_epi16(folded, folded));
+#else
+		limb_t res = 0;
+		for (int i = 0; i < LIMB_NIBBLES; i++)
+			res |= hexValue(s[i]) << (i * 4);
+		return res;
+#endif
+	}
+
+	//write the 16 characters of x
+	static void limbToHex(limb_t x, char *s) {
+#ifdef SIMD_HEX
+		//byte k holds nibbles 2k and 2k + 1, split them and interleave back in order
+		const __m128i b = _mm_cvtsi64_si128((long long)x);
+		const __m128i mask = _mm_set1_epi8(0x0F);
+		const __m128i n = _mm_unpacklo_epi8(_mm_and_si128(b, mask), _mm_and_si128(_mm_srli_epi16(b, 4), mask));
+		const __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(n, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '0' - 10));
+		_mm_storeu_si128((__m128i*)s, _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')), letter));
+#else
+		const char tbl[16] = {
+			'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'
 		};
+		for (int i = 0; i < LIMB_NIBBLES; i++)
+			s[i] = tbl[(x >> (i * 4)) & 0xF];
+#endif
+	}
+
+	//first character is the least significant nibble
+	void parseHexString(const string &hs) {
+		const size_t full = hs.length() / LIMB_NIBBLES;
+		limbs.assign((hs.length() + LIMB_NIBBLES - 1) / LIMB_NIBBLES, 0);
+		for (size_t i = 0; i < full; i++)
+			limbs[i] = hexToLimb(&hs[i * LIMB_NIBBLES]);
+
+		for (size_t i = full * LIMB_NIBBLES; i < hs.length(); i++)
+			limbs[full] |= hexValue(hs[i]) << (i % LIMB_NIBBLES * 4);
+	}
+
+	//10^(19 * 2^j) for j < count, squared up once per thread and kept for later conversions
+	static const vector<BigInt>& decPowers(size_t count) {
+		static thread_local vector<BigInt> pows;
+		if (pows.empty()) {
+			pows.emplace_back();
+			pows[0].limbs.push_back(DEC_CHUNK);
+		}
+		while (pows.size() < count)
+			pows.push_back(mulDispatch(pows.back(), pows.back()));
+		return pows;
+	}
+
+	//value of the decimal digits s[0 .. len), most significant first, anything but 0-9 reads as 0.
+	//Splits off the low 19 * 2^j digits so both halves are multiplied back with Karatsuba/Toom
+	static BigInt parseDec(const char *s, size_t len) {
+		if (len <= DEC_DIGITS * DEC_SPLIT_THRESHOLD) {
+			BigInt res;
+			size_t i = 0;
+			while (i < len) {
+				const size_t next = i + ((len - i - 1) % DEC_DIGITS + 1);
+				limb_t carry = 0;
+				for (; i < next; i++)
+					carry = carry * 10 + (s[i] >= '0' && s[i] <= '9' ? s[i] - '0' : 0);
+
+				//res = res * 10^19 + chunk (only the first chunk can be shorter)
+				for (limb_t &l : res.limbs)
+					l = mulAdd(l, DEC_CHUNK, 0, carry);
+				if (carry) res.limbs.push_back(carry);
+			}
+			return res;
+		}
+
+		size_t level = 0;
+		while ((size_t)DEC_DIGITS << (level + 1) < len) level++;
+		const size_t low = (size_t)DEC_DIGITS << level;
 
-		bits.resize(hs.length() * 4);
-		for (int i = 0; i < hs.length(); i++) {
-			int idx = 0;
-			char c = hs[i];
+		BigInt res = mulDispatch(parseDec(s, len - low), decPowers(level + 1)[level]);
+		addLimbsAt(res, parseDec(s + len - low, low), 0);
+		return res;
+	}
 
-			if (c >= '0' && c <= '9') idx = c - '0';
-			else if (c >= 'A' && c <= 'F') idx = c - 'A' + 10;
+	void parseDecString(const string &ds) {
+		const bool negative = !ds.empty() && ds[0] == '-';
+		*this = parseDec(ds.data() + negative, ds.length() - negative);
+		sign = negative;
+	}
 
-			bits[i * 4 + 0] = tbl[idx][3];
-			bits[i * 4 + 1] = tbl[idx][2];
-			bits[i * 4 + 2] = tbl[idx][1];
-			bits[i * 4 + 3] = tbl[idx][0];
+	//write |n| < 10^(19 * 2^(level + 1)) right aligned so it ends at end, the buffer is already '0' filled.
+	//Above DEC_SPLIT_THRESHOLD limbs n is split by 10^(19 * 2^level) and both halves written on their own
+	static void writeDec(const BigInt &n, const vector<BigInt> &pows, int level, char *end) {
+		if (level < 0 || n.limbs.size() <= DEC_SPLIT_THRESHOLD) {
+			BigInt m = n;
+			while (!isZero(m)) {
+				limb_t r = divSmall(m, DEC_CHUNK);
+				for (int i = 0; i < DEC_DIGITS && (r || !isZero(m)); i++) {
+					*--end = '0' + r % 10;
+					r /= 10;
+				}
+			}
+			return;
 		}
+
+		BigInt q, r;
+		divideUnsigned(n, pows[level], q, r);
+		writeDec(r, pows, level - 1, end);
+		writeDec(q, pows, level - 1, end - ((size_t)DEC_DIGITS << level));
 	}
 
 	void parseLongLong(long long n) {
+		unsigned long long m = n;
 		if (n < 0) {
 			sign = 1;
-			n = -n;
-		}
-		while (n) {
-			bits.push_back(n & 1);
-			n >>= 1;
+			m = 0 - m;
 		}
+		if (m) limbs.push_back(m);
 	}
 
 	static bool sameSign(const BigInt &a, const BigInt &b) {
@@ -87,75 +337,247 @@ private:
 	}
 
 	static bool isEqual(const BigInt &a, const BigInt &b) {
-		if (isZero(a) && isZero(b)) return 1;
-
-		return (a.sign == b.sign) && (a.bits == b.bits);
+		return (a.sign == b.sign) && (a.limbs == b.limbs);
 	}
 
-	static int compare(BigInt a, BigInt b) {
-		a.clean();
-		b.clean();
+	static int compareUnsigned(const BigInt &a, const BigInt &b) {
+		if (a.limbs.size() > b.limbs.size()) return 1;
+		else if (a.limbs.size() < b.limbs.size()) return -1;
 
-		if (isZero(a) && isZero(b)) return 0;
+		for (int i = a.limbs.size() - 1; i >= 0; i--) {
+			if (a.limbs[i] > b.limbs[i]) return 1;
+			else if (a.limbs[i] < b.limbs[i]) return -1;
+		}
+
+		return 0;
+	}
+
+	static int compare(const BigInt &a, const BigInt &b) {
 		if (a.sign != b.sign) return IS_POSITIVE(a) ? 1 : -1;
 
 		int larger = 1;
 		if (a.sign) larger = -1;
 
-		if (a.bits.size() > b.bits.size()) return larger;
-		else if (a.bits.size() < b.bits.size()) return -larger;
-
-		for (int i = a.bits.size() - 1; i >= 0; i--) {
-			if (a.bits[i] > b.bits[i]) return larger;
-			else if (a.bits[i] < b.bits[i]) return -larger;
-		}
-
-		return 0;
+		return larger * compareUnsigned(a, b);
 	}
 
 	static BigInt addUnsigned(const BigInt &a, const BigInt &b) {
+		const bool aLonger = a.limbs.size() >= b.limbs.size();
+		const vector<limb_t> &lg = aLonger ? a.limbs : b.limbs;
+		const vector<limb_t> &sm = aLonger ? b.limbs : a.limbs;
+
 		BigInt res;
-		int carry = 0;
+		res.limbs.resize(lg.size() + 1);
 
-		int m = max(a.bits.size(), b.bits.size());
-		res.bits.resize(m + 1);
+		limb_t carry = 0;
+		size_t i = 0;
+		for (; i < sm.size(); i++)
+			res.limbs[i] = addCarry(lg[i], sm[i], carry);
+		for (; i < lg.size(); i++)
+			res.limbs[i] = addCarry(lg[i], 0, carry);
+		res.limbs[i] = carry;
 
-		for (int i = 0; i < m; i++) {
-			int tb = a[i];
-			int ob = b[i];
-			int toSum = tb + ob + carry;
-			res.bits[i] = toSum % 2;
-			carry = toSum > 1;
-		}
-		if (carry) res.bits[m] = 1;
-		else res.clean();
+		res.clean();
 		return res;
 	}
 
+	//assume |large| >= |small|
 	static BigInt subUnsinged(const BigInt &large, const BigInt &small) {
 		BigInt res;
-		int carry = 0;
+		res.limbs.resize(large.limbs.size());
 
-		res.bits.resize(large.bits.size());
+		limb_t borrow = 0;
+		size_t i = 0;
+		for (; i < small.limbs.size(); i++)
+			res.limbs[i] = subBorrow(large.limbs[i], small.limbs[i], borrow);
+		for (; i < large.limbs.size(); i++)
+			res.limbs[i] = subBorrow(large.limbs[i], 0, borrow);
 
-		for (int i = 0; i < large.bits.size(); i++) {
-			int lg = large.bits[i]; //no check OOB
-			int sm = small[i]; //check for OOB
-			int toSub = lg - carry - sm;
-			carry = toSub < 0;
+		res.clean();
+		return res;
+	}
+
+	//|large| -= |small| reusing the buffer of large, assume |large| >= |small|
+	static void subInPlace(BigInt &large, const BigInt &small) {
+		limb_t borrow = 0;
+		size_t i = 0;
+		for (; i < small.limbs.size(); i++)
+			large.limbs[i] = subBorrow(large.limbs[i], small.limbs[i], borrow);
+		for (; borrow && i < large.limbs.size(); i++)
+			large.limbs[i] = subBorrow(large.limbs[i], 0, borrow);
+
+		large.clean();
+	}
+
+	//res[0 .. na + nb) = a * b, schoolbook on raw limbs, res must not overlap a or b
+	static void mulRaw(const limb_t *a, size_t na, const limb_t *b, size_t nb, limb_t *res) {
+		fill(res, res + na + nb, 0);
+		for (size_t i = 0; i < na; i++) {
+			limb_t carry = 0;
+			for (size_t j = 0; j < nb; j++)
+				res[i + j] = mulAdd(a[i], b[j], res[i + j], carry);
+			res[i + nb] = carry;
+		}
+	}
+
+	static BigInt mulUnsigned(const BigInt &a, const BigInt &b) {
+		BigInt res;
+		res.limbs.resize(a.limbs.size() + b.limbs.size());
+		mulRaw(a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size(), res.limbs.data());
+
+		res.clean();
+		return res;
+	}
+
+	//limbs [from, from + count) of |n|
+	static BigInt sliceLimbs(const BigInt &n, size_t from, size_t count) {
+		BigInt res;
+		if (from < n.limbs.size())
+			res.limbs.assign(n.limbs.begin() + from, n.limbs.begin() + min(n.limbs.size(), from + count));
+		res.clean();
+		return res;
+	}
+
+	//|acc| += |x| * 2^(64 * offset)
+	static void addLimbsAt(BigInt &acc, const BigInt &x, size_t offset) {
+		if (acc.limbs.size() < offset + x.limbs.size())
+			acc.limbs.resize(offset + x.limbs.size());
 
-			res.bits[i] = toSub == 1 || toSub == -1;
+		limb_t carry = 0;
+		size_t i = offset;
+		for (limb_t l : x.limbs) {
+			acc.limbs[i] = addCarry(acc.limbs[i], l, carry);
+			i++;
 		}
+		for (; carry; i++) {
+			if (i == acc.limbs.size()) acc.limbs.push_back(0);
+			acc.limbs[i] = addCarry(acc.limbs[i], 0, carry);
+		}
+		acc.clean();
+	}
+
+	//|n| /= d in place, return the remainder
+	static limb_t divSmall(BigInt &n, limb_t d) {
+		limb_t rem = 0;
+		for (int i = n.limbs.size() - 1; i >= 0; i--)
+			n.limbs[i] = divWide(rem, n.limbs[i], d, rem);
+		n.clean();
+		return rem;
+	}
+
+	//|n| mod d without touching n
+	static limb_t modSmall(const BigInt &n, limb_t d) {
+		limb_t rem = 0;
+		for (int i = n.limbs.size() - 1; i >= 0; i--)
+			divWide(rem, n.limbs[i], d, rem);
+		return rem;
+	}
+
+	//(a * b) % n for a, b < n, the product is kept in 128 bits
+	static limb_t mulModWord(limb_t a, limb_t b, limb_t n) {
+		limb_t hi = 0, rem;
+		const limb_t lo = mulAdd(a, b, 0, hi);
+		divWide(hi, lo, n, rem);
+		return rem;
+	}
+
+	static BigInt mulSigned(const BigInt &a, const BigInt &b) {
+		BigInt res = mulDispatch(a, b);
+		res.sign = a.sign != b.sign;
 		res.clean();
 		return res;
 	}
 
+	//a * b = z2 * W^2m + ((a0 + a1)(b0 + b1) - z0 - z2) * W^m + z0
+	static BigInt mulKaratsuba(const BigInt &a, const BigInt &b) {
+		const size_t m = (max(a.limbs.size(), b.limbs.size()) + 1) / 2;
+
+		BigInt a0 = sliceLimbs(a, 0, m), a1 = sliceLimbs(a, m, m);
+		BigInt b0 = sliceLimbs(b, 0, m), b1 = sliceLimbs(b, m, m);
+
+		BigInt z0 = mulDispatch(a0, b0);
+		BigInt z2 = mulDispatch(a1, b1);
+		BigInt z1 = mulDispatch(addUnsigned(a0, a1), addUnsigned(b0, b1));
+		z1 = subUnsinged(subUnsinged(z1, z0), z2);
+
+		BigInt res = z0;
+		addLimbsAt(res, z1, m);
+		addLimbsAt(res, z2, 2 * m);
+		return res;
+	}
+
+	//Toom-Cook 3-way, evaluate at 0, 1, -1, -2, inf and interpolate with Bodrato's sequence
+	static BigInt mulToom3(const BigInt &a, const BigInt &b) {
+		const size_t m = (max(a.limbs.size(), b.limbs.size()) + 2) / 3;
+
+		BigInt a0 = sliceLimbs(a, 0, m), a1 = sliceLimbs(a, m, m), a2 = sliceLimbs(a, 2 * m, m);
+		BigInt b0 = sliceLimbs(b, 0, m), b1 = sliceLimbs(b, m, m), b2 = sliceLimbs(b, 2 * m, m);
+
+		BigInt pa = a0 + a2;
+		BigInt pa1 = pa + a1;
+		BigInt pam1 = pa - a1;
+		BigInt pam2 = ((pam1 + a2) << 1) - a0;
+
+		BigInt pb = b0 + b2;
+		BigInt pb1 = pb + b1;
+		BigInt pbm1 = pb - b1;
+		BigInt pbm2 = ((pbm1 + b2) << 1) - b0;
+
+		BigInt r0 = mulDispatch(a0, b0);
+		BigInt r1 = mulSigned(pa1, pb1);
+		BigInt rm1 = mulSigned(pam1, pbm1);
+		BigInt rm2 = mulSigned(pam2, pbm2);
+		BigInt rinf = mulDispatch(a2, b2);
+
+		//every division here is exact, and shifts act on the magnitude
+		BigInt t3 = rm2 - r1;
+		divSmall(t3, 3);
+		BigInt t1 = (r1 - rm1) >> 1;
+		BigInt t2 = rm1 - r0;
+		t3 = ((t2 - t3) >> 1) + (rinf << 1);
+		t2 = t2 + t1 - rinf;
+		t1 = t1 - t3;
+
+		BigInt res = r0;
+		addLimbsAt(res, t1, m);
+		addLimbsAt(res, t2, 2 * m);
+		addLimbsAt(res, t3, 3 * m);
+		addLimbsAt(res, rinf, 4 * m);
+		return res;
+	}
+
+	//|a| * |b|, picks the tier from the smaller operand
+	static BigInt mulDispatch(const BigInt &a, const BigInt &b) {
+		const bool aLonger = a.limbs.size() >= b.limbs.size();
+		const BigInt &lg = aLonger ? a : b;
+		const BigInt &sm = aLonger ? b : a;
+		const size_t n = sm.limbs.size();
+
+		if (n < KARATSUBA_THRESHOLD)
+			return mulUnsigned(a, b);
+
+		if (lg.limbs.size() >= 2 * n) {
+			//unbalanced, multiply n-limb slices of the larger operand
+			BigInt res;
+			for (size_t i = 0; i < lg.limbs.size(); i += n)
+				addLimbsAt(res, mulDispatch(sliceLimbs(lg, i, n), sm), i);
+			return res;
+		}
+
+		if (n < TOOM3_THRESHOLD)
+			return mulKaratsuba(a, b);
+		return mulToom3(a, b);
+	}
+
 	static void divideUnsigned(const BigInt &a, BigInt b, BigInt &q, BigInt &r) {
 		int msb = 0;
 		if ((msb = isPowerOfTwo(b)) != -1) {
 			q = a >> msb;
 			r = a;
-			r.bits.resize(msb);
+			size_t words = (msb + LIMB_BITS - 1) / LIMB_BITS;
+			if (r.limbs.size() > words) r.limbs.resize(words);
+			if (msb % LIMB_BITS && r.limbs.size() == words)
+				r.limbs.back() &= ((limb_t)1 << (msb % LIMB_BITS)) - 1;
 			r.clean();
 			return;
 		}
@@ -172,20 +594,75 @@ private:
 			return;
 		}
 
+		if (b.limbs.size() == 1) {
+			q = a;
+			r = 0;
+			limb_t rem = divSmall(q, b.limbs[0]);
+			if (rem) r.limbs.push_back(rem);
+			return;
+		}
+
+		//Knuth, TAOCP vol. 2, 4.3.1 Algorithm D
+		//D1: normalize so the top limb of the divisor has its high bit set
+		const int shift = countLeadingZeros(b.limbs.back());
+		b <<= shift;
+		BigInt u = a << shift;
+		u.limbs.resize(a.limbs.size() + 1);
+
+		const vector<limb_t> &v = b.limbs;
+		const int n = v.size();
+		const int m = a.limbs.size() - n;
+
 		q = 0;
-		q.bits.resize(a.bits.size());
-		r = 0;
-		for (int i = a.bits.size() - 1; i >= 0; i--) {
-			r <<= 1;
-			r.bits[0] = a.bits[i];
-			r.clean();
-			if (r >= b) {
-				r = subUnsinged(r, b);
-				q.bits[i] = 1;
+		q.limbs.assign(m + 1, 0);
+
+		for (int j = m; j >= 0; j--) {
+			//D3: estimate the quotient limb from the top two limbs, then refine with the third
+			limb_t qhat, rhat;
+			bool rhatOverflow = 0;
+			if (u.limbs[j + n] >= v[n - 1]) {
+				qhat = ~(limb_t)0;
+				rhat = u.limbs[j + n - 1] + v[n - 1];
+				rhatOverflow = rhat < v[n - 1];
+			}
+			else
+				qhat = divWide(u.limbs[j + n], u.limbs[j + n - 1], v[n - 1], rhat);
+
+			while (!rhatOverflow) {
+				limb_t hi = 0;
+				limb_t lo = mulAdd(qhat, v[n - 2], 0, hi);
+				if (hi < rhat || (hi == rhat && lo <= u.limbs[j + n - 2])) break;
+				qhat--;
+				rhat += v[n - 1];
+				rhatOverflow = rhat < v[n - 1];
 			}
+
+			//D4: u[j .. j + n] -= qhat * v
+			limb_t carry = 0;
+			limb_t borrow = 0;
+			for (int i = 0; i < n; i++) {
+				limb_t p = mulAdd(qhat, v[i], 0, carry);
+				u.limbs[i + j] = subBorrow(u.limbs[i + j], p, borrow);
+			}
+			u.limbs[j + n] = subBorrow(u.limbs[j + n], carry, borrow);
+
+			//D6: qhat was one too large, add v back
+			if (borrow) {
+				qhat--;
+				carry = 0;
+				for (int i = 0; i < n; i++)
+					u.limbs[i + j] = addCarry(u.limbs[i + j], v[i], carry);
+				u.limbs[j + n] += carry;
+			}
+
+			q.limbs[j] = qhat;
 		}
 		q.clean();
-		r.clean();
+
+		//D8: the remainder is the low n limbs, unnormalized
+		u.limbs.resize(n);
+		u.clean();
+		r = u >> shift;
 	}
 
 	static void divide(BigInt a, BigInt b, BigInt &q, BigInt &r) {
@@ -219,18 +696,148 @@ private:
 		divideUnsigned(a, b, q, r);
 	}
 
-	static bool millerRabinWitness(const BigInt &n, const BigInt &n1, const BigInt &d, const int &s, const BigInt &base) {
-		BigInt x = powMod(base, d, n);
-		BigInt y;
-		for (int j = 0; j < s; j++) {
-			y = mulMod(x, x, n);
-			if (y == 1 && x != 1 && x != n1)
-				return 0;
-			x = y;
+	//x * w for a signed machine word w
+	static BigInt mulWordSigned(const BigInt &x, long long w) {
+		BigInt res;
+		if (isZero(x) || w == 0) return res;
+
+		const limb_t m = w < 0 ? 0 - (limb_t)w : (limb_t)w;
+		res.limbs.resize(x.limbs.size() + 1);
+		limb_t carry = 0;
+		for (size_t i = 0; i < x.limbs.size(); i++)
+			res.limbs[i] = mulAdd(x.limbs[i], m, 0, carry);
+		res.limbs.back() = carry;
+		res.sign = x.sign != (w < 0);
+		res.clean();
+		return res;
+	}
+
+	//Lehmer's Euclid for u, v >= 0 (Knuth 4.5.2 Algorithm L). Most steps run on the
+	//leading 62 bits of u and v, and the collected 2x2 matrix is applied to the full
+	//numbers once per round. Returns gcd(u, v), and if s is given it also tracks the
+	//cofactor so that s * u = gcd (mod v) for the original u and v
+	static BigInt lehmerGcd(BigInt u, BigInt v, BigInt *s) {
+		BigInt s0 = 1, s1 = 0;
+		//the leading words are taken from u, so keep u >= v
+		if (compareUnsigned(u, v) < 0) {
+			swap(u, v);
+			swap(s0, s1);
 		}
-		if (y != 1)
-			return 0;
 
+		while (!isZero(v)) {
+			const int shift = max(0, u.bitLength() - 62);
+			long long x = u.getBits(shift, 62), y = v.getBits(shift, 62);
+			long long A = 1, B = 0, C = 0, D = 1;
+
+			//q is the true quotient as long as both ends of the interval agree
+			while (y + C > 0 && y + D > 0) {
+				long long q = (x + A) / (y + C);
+				if (q != (x + B) / (y + D)) break;
+
+				long long t = A - q * C; A = C; C = t;
+				t = B - q * D; B = D; D = t;
+				t = x - q * y; x = y; y = t;
+			}
+
+			if (B == 0) {
+				//no single word step was certain, do one full division
+				BigInt q, r;
+				divideUnsigned(u, v, q, r);
+				u = move(v);
+				v = move(r);
+				if (s) {
+					BigInt t = s0 - q * s1;
+					s0 = move(s1);
+					s1 = move(t);
+				}
+				continue;
+			}
+
+			BigInt nu = mulWordSigned(u, A) + mulWordSigned(v, B);
+			v = mulWordSigned(u, C) + mulWordSigned(v, D);
+			u = move(nu);
+			if (s) {
+				BigInt ns = mulWordSigned(s0, A) + mulWordSigned(s1, B);
+				s1 = mulWordSigned(s0, C) + mulWordSigned(s1, D);
+				s0 = move(ns);
+			}
+		}
+
+		if (s) *s = move(s0);
+		return u;
+	}
+
+	//First SMALL_PRIME_COUNT odd primes, sieved once
+	static const vector<limb_t>& smallPrimes() {
+		static const vector<limb_t> primes = []() {
+			const int limit = 20000; //holds the first 2262 primes
+			vector<char> composite(limit, 0);
+			vector<limb_t> res;
+			for (int i = 3; i < limit && res.size() < SMALL_PRIME_COUNT; i += 2) {
+				if (composite[i]) continue;
+				res.push_back(i);
+				for (long long j = (long long)i * i; j < limit; j += 2 * i)
+					composite[j] = 1;
+			}
+			return res;
+		}();
+		return primes;
+	}
+
+	//Trial division of an odd n > 2 by the small primes, several primes per limb division:
+	//n is reduced once modulo a product of primes that fits in a limb, then each prime
+	//checks that remainder. Return 1 if n is prime, 0 if composite, -1 if undecided
+	static int trialDivision(const BigInt &n) {
+		const vector<limb_t> &primes = smallPrimes();
+		const bool oneLimb = n.limbs.size() == 1;
+
+		size_t i = 0;
+		while (i < primes.size()) {
+			size_t j = i;
+			limb_t product = 1;
+			while (j < primes.size() && product <= ~(limb_t)0 / primes[j])
+				product *= primes[j++];
+
+			const limb_t r = modSmall(n, product);
+			for (; i < j; i++) {
+				if (oneLimb && primes[i] * primes[i] > n.limbs[0])
+					return 1;
+				if (r % primes[i] == 0)
+					return oneLimb && n.limbs[0] == primes[i];
+			}
+		}
+		return -1;
+	}
+
+	//|n| mod every small prime, one limb division per group of primes
+	static vector<limb_t> smallPrimeResidues(const BigInt &n) {
+		const vector<limb_t> &primes = smallPrimes();
+		vector<limb_t> res(primes.size());
+
+		size_t i = 0;
+		while (i < primes.size()) {
+			size_t j = i;
+			limb_t product = 1;
+			while (j < primes.size() && product <= ~(limb_t)0 / primes[j])
+				product *= primes[j++];
+
+			const limb_t r = modSmall(n, product);
+			for (; i < j; i++)
+				res[i] = r % primes[i];
+		}
+		return res;
+	}
+
+	//Calls f(FixedBigInt<Bits>()) for the key size n fills more than half of (512, 1024, 2048
+	//or 4096 bits) and returns 1, returns 0 for smaller or larger n
+	template <class F>
+	static bool withFixedWidth(const BigInt &n, F &&f) {
+		const size_t k = n.limbs.size();
+		if (k > 4 && k <= 8) f(FixedBigInt<512>());
+		else if (k > 8 && k <= 16) f(FixedBigInt<1024>());
+		else if (k > 16 && k <= 32) f(FixedBigInt<2048>());
+		else if (k > 32 && k <= 64) f(FixedBigInt<4096>());
+		else return 0;
 		return 1;
 	}
 
@@ -244,24 +851,35 @@ private:
 			2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37
 		};
 
-		bool less_than_32 = n.bits.size() <= 32;
-		bool less_than_64 = n.bits.size() <= 64;
+		bool less_than_32 = n.bitLength() <= 32;
+		bool less_than_64 = n.bitLength() <= 64;
 
 		if (less_than_32) times = sizeof(deterministic_32) / sizeof(int);
 		else if (less_than_64) times = sizeof(deterministic_64) / sizeof(int);
 
-		BigInt n1 = n - 1;
-		BigInt n2 = n - 2;
-		BigInt d = n1;
-		int s = 0;
-
-		while (d % 2 == 0) {
-			d >>= 1;
-			s++;
+		const BigInt n1 = n - 1;
+		const BigInt n2 = n - 2;
+		const int s = firstSetBit(n1);
+		const BigInt d = n1 >> s;
+
+		//One round for base a, on a FixedBigInt when n has a key size so the rounds never allocate
+		function<bool(const BigInt&, const atomic<bool>*)> witness;
+		const bool fixed = withFixedWidth(n, [&](auto width) {
+			typedef decltype(width) Fixed;
+			auto mont = make_shared<const typename Fixed::Montgomery>((Fixed)n);
+			witness = [mont, &d, s](const BigInt &a, const atomic<bool> *stop) {
+				return mont->millerRabinWitness(d.limbs.data(), d.limbs.size(), s, (Fixed)a, stop);
+			};
+		});
+		if (!fixed) {
+			auto mont = make_shared<const Montgomery>(n);
+			witness = [mont, &d, s](const BigInt &a, const atomic<bool> *stop) {
+				return mont->millerRabinWitness(d, s, a, stop);
+			};
 		}
 
 #ifdef PARALLEL_PRIME_CHECK
-		vector<thread> threads;
+		TaskGroup witnesses;
 		atomic<bool> prime(1);
 #endif
 
@@ -269,7 +887,7 @@ private:
 			BigInt a;
 			if (less_than_32) {
 				a = deterministic_32[i];
-				if (a == n) continue; //This is for sure a prime, but early return messes with threads and it's cheap to skip it 
+				if (a == n) continue; //This is for sure a prime, but early return messes with threads and it's cheap to skip it
 			}
 			else if (less_than_64) {
 				a = deterministic_64[i];
@@ -279,22 +897,22 @@ private:
 				a = rand(2, n2);
 
 #ifdef PARALLEL_PRIME_CHECK
-			threads.emplace_back([n, n1, d, s, a, &prime]() {
-				bool res = millerRabinWitness(n, n1, d, s, a);
+			witnesses.run([&witness, a, &prime, &witnesses]() {
+				bool res = witness(a, &witnesses.cancelled);
 
-				if (!res) //One test failed
+				if (!res && !witnesses.cancelled) { //One test failed, the others can stop
 					prime = 0;
+					witnesses.cancel();
+				}
 			});
 #else
-			if (!millerRabinWitness(n, n1, d, s, a)) return 0;
+			if (!witness(a, nullptr)) return 0;
 #endif
 		}
 
 #ifdef PARALLEL_PRIME_CHECK
-		//Wait for threads to finish
-		for (thread &t: threads) {
-			t.join();
-		}
+		//Wait for the witnesses, this thread runs queued ones meanwhile
+		witnesses.wait();
 
 		return prime;
 #else
@@ -307,12 +925,15 @@ public:
 
 	BigInt(const BigInt&) = default;
 
+	BigInt(BigInt&&) = default;
+
 	BigInt(const string &s, int base = 16) {
 		switch (base) {
 			case 16:
 				parseHexString(s);
 				break;
 			case 10:
+				parseDecString(s);
 				break;
 			case 2:
 				parseBinaryString(s);
@@ -325,9 +946,28 @@ public:
 		parseLongLong(n);
 	}
 
+	template <int Bits>
+	explicit BigInt(const FixedBigInt<Bits> &x) {
+		limbs.assign(x.limbs.begin(), x.limbs.end());
+		clean();
+	}
+
+	//throws when the value is negative or needs more than Bits bits
+	template <int Bits>
+	explicit operator FixedBigInt<Bits>() const {
+		if (IS_NEGATIVE(*this) || limbs.size() > FixedBigInt<Bits>::LIMBS)
+			throw logic_error("BigInt does not fit in FixedBigInt");
+
+		FixedBigInt<Bits> res;
+		copy(limbs.begin(), limbs.end(), res.limbs.begin());
+		return res;
+	}
+
 	//Asignment
 	BigInt& operator=(const BigInt &other) = default;
 
+	BigInt& operator=(BigInt &&other) = default;
+
 	~BigInt() = default;
 
 	//Math
@@ -352,6 +992,7 @@ public:
 
 		BigInt res = addUnsigned(*this, other);
 		res.sign = this->sign;
+		res.clean();
 
 		return res;
 	}
@@ -361,15 +1002,13 @@ public:
 			return *this + (-other);
 		}
 
-		BigInt lhs = abs(*this);
-		BigInt rhs = abs(other);
-
-		const bool bigger = lhs > rhs;
-		BigInt &large = bigger ? lhs : rhs;
-		BigInt &small = bigger ? rhs : lhs;
+		const bool bigger = compareUnsigned(*this, other) > 0;
+		const BigInt &large = bigger ? *this : other;
+		const BigInt &small = bigger ? other : *this;
 
 		BigInt res = subUnsinged(large, small);
 		res.sign = !bigger ^ (this->sign);
+		res.clean();
 
 		return res;
 	}
@@ -393,19 +1032,34 @@ public:
 			return res;
 		}
 
-		BigInt rhs = abs(other);
-
-		for (int i = 0; i < this->bits.size(); i++) {
-			if (this->bits[i])
-				res = res + rhs;
-			rhs <<= 1;
-		}
-
+		res = mulDispatch(*this, other);
 		res.sign = (this->sign != other.sign);
 
 		return res;
 	}
 
+	//Multiply with a forced top level tier (sub products still use the dispatcher), used by bench.cpp
+	static BigInt multiply(const BigInt &a, const BigInt &b, MulAlgorithm algo = MUL_AUTO) {
+		BigInt res;
+		switch (algo) {
+			case MUL_SCHOOLBOOK:
+				res = mulUnsigned(a, b);
+				break;
+			case MUL_KARATSUBA:
+				res = mulKaratsuba(a, b);
+				break;
+			case MUL_TOOM3:
+				res = mulToom3(a, b);
+				break;
+			default:
+				res = mulDispatch(a, b);
+				break;
+		}
+		res.sign = a.sign != b.sign;
+		res.clean();
+		return res;
+	}
+
 	BigInt operator/(const BigInt &other) const {
 		BigInt q, r;
 		divide(*this, other, q, r);
@@ -427,84 +1081,591 @@ public:
 		return a;
 	}
 
+	//Scratch limb buffers for temporaries, like OpenSSL's BN_CTX. Every thread keeps its own stack
+	//of buffers with their capacity, a Frame hands buffers out and takes them all back when it goes
+	//out of scope. Hot loops stop calling malloc once the stack has grown, and threads never share it.
+	//Frames only live on the stack, so they always end in reverse order
+	class Arena {
+	private:
+		//deque, growing it never moves the buffers already handed out
+		static deque<vector<limb_t>>& buffers() {
+			static thread_local deque<vector<limb_t>> stack;
+			return stack;
+		}
+
+		static size_t& used() {
+			static thread_local size_t top = 0;
+			return top;
+		}
+
+	public:
+		class Frame {
+		private:
+			const size_t start;
+
+		public:
+			Frame() : start(used()) {}
+
+			Frame(const Frame&) = delete;
+
+			Frame& operator=(const Frame&) = delete;
+
+			~Frame() {
+				used() = start;
+			}
+
+			//size zeroed limbs, valid until the frame ends
+			limb_t* get(size_t size) {
+				deque<vector<limb_t>> &stack = buffers();
+				size_t &top = used();
+				if (top == stack.size())
+					stack.emplace_back();
+
+				vector<limb_t> &buf = stack[top++];
+				buf.assign(size, 0);
+				return buf.data();
+			}
+		};
+	};
+
+	//Montgomery arithmetic for a fixed odd modulus n, with R = 2^(64 * limbs of n)
+	//Build once per modulus and share it, every method is const and thread safe
+	class Montgomery {
+		friend class DiscreteLog;
+
+	private:
+		vector<limb_t> mod;
+		vector<limb_t> r1; //R mod n
+		vector<limb_t> r2; //R^2 mod n
+		limb_t nInv; //-n^-1 mod 2^64
+
+		static BigInt fromRaw(const vector<limb_t> &v) {
+			BigInt res;
+			res.limbs = v;
+			res.clean();
+			return res;
+		}
+
+		static BigInt fromRaw(const limb_t *v, size_t k) {
+			BigInt res;
+			res.limbs.assign(v, v + k);
+			res.clean();
+			return res;
+		}
+
+		//copy a reduced value into a buffer of exactly k limbs
+		vector<limb_t> toRaw(const BigInt &a) const {
+			vector<limb_t> res(a.limbs);
+			res.resize(mod.size());
+			return res;
+		}
+
+		//same, into k limbs of frame scratch
+		limb_t* load(Arena::Frame &frame, const BigInt &a) const {
+			limb_t *res = frame.get(mod.size());
+			copy(a.limbs.begin(), a.limbs.begin() + min(a.limbs.size(), mod.size()), res);
+			return res;
+		}
+
+		//0 <= a < n, compared without building n
+		bool isReduced(const BigInt &a) const {
+			if (IS_NEGATIVE(a) && !isZero(a)) return 0;
+			if (a.limbs.size() != mod.size()) return a.limbs.size() < mod.size();
+			for (int i = mod.size() - 1; i >= 0; i--) {
+				if (a.limbs[i] != mod[i])
+					return a.limbs[i] < mod[i];
+			}
+			return 0;
+		}
+
+		//res = a * b * R^-1 mod n (CIOS), a/b/res hold k limbs and may alias, t is k + 2 limbs of scratch
+		void montMul(const limb_t *a, const limb_t *b, limb_t *res, limb_t *t) const {
+			const size_t k = mod.size();
+			const limb_t *m = mod.data();
+
+			fill(t, t + k + 2, 0);
+			for (size_t i = 0; i < k; i++) {
+				limb_t carry = 0;
+				for (size_t j = 0; j < k; j++)
+					t[j] = mulAdd(a[j], b[i], t[j], carry);
+				limb_t c = 0;
+				t[k] = addCarry(t[k], carry, c);
+				t[k + 1] = c;
+
+				const limb_t u = t[0] * nInv;
+				carry = 0;
+				mulAdd(u, m[0], t[0], carry);
+				for (size_t j = 1; j < k; j++)
+					t[j - 1] = mulAdd(u, m[j], t[j], carry);
+				c = 0;
+				t[k - 1] = addCarry(t[k], carry, c);
+				t[k] = t[k + 1] + c;
+			}
+
+			//t < 2n, so subtract n once and keep the difference unless it borrowed (branch free)
+			limb_t borrow = 0;
+			for (size_t i = 0; i < k; i++)
+				res[i] = subBorrow(t[i], m[i], borrow);
+			subBorrow(t[k], 0, borrow);
+
+			const limb_t mask = borrow - 1;
+			for (size_t i = 0; i < k; i++)
+				res[i] = (res[i] & mask) | (t[i] & ~mask);
+		}
+
+		//same thresholds as OpenSSL's BN_window_bits_for_exponent_size
+		static int windowBits(int expBits) {
+			if (expBits > 671) return 6;
+			if (expBits > 239) return 5;
+			if (expBits > 79) return 4;
+			if (expBits > 23) return 3;
+			return 1;
+		}
+
+	public:
+		Montgomery(const BigInt &n) {
+			if (!n[0] || IS_NEGATIVE(n) || n == 1)
+				throw logic_error("Montgomery modulus must be odd and greater than 1");
+
+			mod = n.limbs;
+			const size_t k = mod.size();
+
+			//Newton iteration, every step doubles the number of correct low bits (3 -> 96)
+			limb_t inv = mod[0];
+			for (int i = 0; i < 5; i++)
+				inv *= 2 - mod[0] * inv;
+			nInv = 0 - inv;
+
+			r1 = toRaw((BigInt(1) << (k * LIMB_BITS)) % n);
+			r2 = toRaw((BigInt(1) << (2 * k * LIMB_BITS)) % n);
+		}
+
+		BigInt modulus() const {
+			return fromRaw(mod);
+		}
+
+		//Montgomery form of 1
+		BigInt one() const {
+			return fromRaw(r1);
+		}
+
+		BigInt toMont(const BigInt &a) const {
+			Arena::Frame frame;
+			limb_t *x = load(frame, isReduced(a) ? a : a % modulus());
+			limb_t *t = frame.get(mod.size() + 2);
+			montMul(x, r2.data(), x, t);
+			return fromRaw(x, mod.size());
+		}
+
+		BigInt fromMont(const BigInt &aM) const {
+			Arena::Frame frame;
+			limb_t *x = load(frame, aM);
+			limb_t *one = frame.get(mod.size());
+			limb_t *t = frame.get(mod.size() + 2);
+			one[0] = 1;
+			montMul(x, one, x, t);
+			return fromRaw(x, mod.size());
+		}
+
+		//Montgomery product of two values already in Montgomery form
+		BigInt mul(const BigInt &aM, const BigInt &bM) const {
+			Arena::Frame frame;
+			limb_t *x = load(frame, aM);
+			limb_t *y = load(frame, bM);
+			limb_t *t = frame.get(mod.size() + 2);
+			montMul(x, y, x, t);
+			return fromRaw(x, mod.size());
+		}
+
+		//y = base ^ b on k limbs in Montgomery form, y must not alias base.
+		//stop (optional) is polled once per window to abandon the computation early
+		void expRaw(const limb_t *base, const BigInt &b, ExpMode mode, const atomic<bool> *stop, limb_t *y) const {
+			const size_t k = mod.size();
+			const int bits = b.bitLength();
+			const int w = windowBits(bits);
+
+			Arena::Frame frame;
+			limb_t *t = frame.get(k + 2);
+			copy(r1.begin(), r1.end(), y);
+
+			if (mode == FIXED_WINDOW) {
+				//table[i] = a^i for every w-bit digit
+				const int size = 1 << w;
+				limb_t *table = frame.get(size * k);
+				copy(r1.begin(), r1.end(), table);
+				for (int i = 1; i < size; i++)
+					montMul(&table[(i - 1) * k], base, &table[i * k], t);
+
+				limb_t *pick = frame.get(k);
+				for (int pos = (bits + w - 1) / w * w - w; pos >= 0; pos -= w) {
+					if (stop && *stop) break;
+					for (int j = 0; j < w; j++)
+						montMul(y, y, y, t);
+
+					const limb_t digit = b.getBits(pos, w);
+					fill(pick, pick + k, 0);
+					for (int i = 0; i < size; i++) {
+						const limb_t mask = 0 - (limb_t)((limb_t)i == digit);
+						for (size_t j = 0; j < k; j++)
+							pick[j] |= table[i * k + j] & mask;
+					}
+					montMul(y, pick, y, t);
+				}
+				return;
+			}
+
+			//table[i] = a^(2i + 1), only odd powers are needed since windows end on a set bit
+			limb_t *table = frame.get((1 << (w - 1)) * k);
+			copy(base, base + k, table);
+			if (w > 1) {
+				limb_t *sq = frame.get(k);
+				montMul(base, base, sq, t);
+				for (int i = 1; i < (1 << (w - 1)); i++)
+					montMul(&table[(i - 1) * k], sq, &table[i * k], t);
+			}
+
+			int i = bits - 1;
+			while (i >= 0) {
+				if (stop && *stop) break;
+				if (!b[i]) {
+					montMul(y, y, y, t);
+					i--;
+					continue;
+				}
+
+				int j = max(i - w + 1, 0);
+				while (!b[j]) j++;
+
+				for (int s = j; s <= i; s++)
+					montMul(y, y, y, t);
+				montMul(y, &table[(b.getBits(j, i - j + 1) >> 1) * k], y, t);
+				i = j - 1;
+			}
+		}
+
+		//aM ^ b, input and output in Montgomery form
+		//stop (optional) is polled once per window to abandon the computation early
+		BigInt exp(const BigInt &aM, const BigInt &b, ExpMode mode = SLIDING_WINDOW, const atomic<bool> *stop = nullptr) const {
+			Arena::Frame frame;
+			limb_t *base = load(frame, aM);
+			limb_t *y = frame.get(mod.size());
+			expRaw(base, b, mode, stop, y);
+			return fromRaw(y, mod.size());
+		}
+
+		BigInt mulMod(const BigInt &a, const BigInt &b) const {
+			return fromMont(mul(toMont(a), toMont(b)));
+		}
+
+		BigInt powMod(const BigInt &a, const BigInt &b, ExpMode mode = SLIDING_WINDOW) const {
+			Arena::Frame frame;
+			const size_t k = mod.size();
+			limb_t *t = frame.get(k + 2);
+			limb_t *x = load(frame, isReduced(a) ? a : a % modulus());
+			limb_t *y = frame.get(k);
+			montMul(x, r2.data(), x, t);
+			expRaw(x, b, mode, nullptr, y);
+
+			//leave Montgomery form, y * 1 * R^-1
+			fill(x, x + k, 0);
+			x[0] = 1;
+			montMul(y, x, y, t);
+			return fromRaw(y, k);
+		}
+
+		//One Miller-Rabin round on n = modulus, n - 1 = d * 2^s and 1 < base < n - 1, all in frame scratch.
+		//Works in Montgomery form, so 1 and n - 1 are compared as R mod n and n - R mod n.
+		//stop is polled between multiplications, the result is meaningless once it is set
+		bool millerRabinWitness(const BigInt &d, int s, const BigInt &base, const atomic<bool> *stop = nullptr) const {
+			const size_t k = mod.size();
+			Arena::Frame frame;
+			limb_t *t = frame.get(k + 2);
+
+			//-1 in Montgomery form is n - R mod n
+			limb_t *minusOne = frame.get(k);
+			limb_t borrow = 0;
+			for (size_t i = 0; i < k; i++)
+				minusOne[i] = subBorrow(mod[i], r1[i], borrow);
+
+			limb_t *a = load(frame, base);
+			montMul(a, r2.data(), a, t);
+
+			limb_t *x = frame.get(k);
+			limb_t *y = frame.get(k);
+			expRaw(a, d, SLIDING_WINDOW, stop, x);
+
+			const limb_t *one = r1.data();
+			for (int j = 0; j < s; j++) {
+				if (stop && *stop)
+					return 0;
+				montMul(x, x, y, t);
+				if (equal(y, y + k, one) && !equal(x, x + k, one) && !equal(x, x + k, minusOne))
+					return 0;
+				swap(x, y);
+			}
+			//x holds the last square
+			if (!s || !equal(x, x + k, one))
+				return 0;
+
+			return 1;
+		}
+	};
+
+	//Barrett reduction for repeated reductions by the same modulus n (any n > 0),
+	//x mod n costs two multiplications instead of a long division
+	class Barrett {
+	private:
+		vector<limb_t> mod;
+		vector<limb_t> mu; //floor(B^2k / n), B = 2^64
+
+		static BigInt fromRaw(const vector<limb_t> &v) {
+			BigInt res;
+			res.limbs = v;
+			res.clean();
+			return res;
+		}
+
+		static BigInt fromRaw(const limb_t *v, size_t k) {
+			BigInt res;
+			res.limbs.assign(v, v + k);
+			res.clean();
+			return res;
+		}
+
+		//x mod n for 0 <= x < B^2k, x holds 2k limbs and the remainder is left in x[0 .. k)
+		void reduceRaw(limb_t *x) const {
+			const size_t k = mod.size();
+			const size_t m = mu.size();
+			Arena::Frame frame;
+
+			//q estimates floor(x / n) from below by at most 2
+			limb_t *q = frame.get(k + 1 + m);
+			mulRaw(x + k - 1, k + 1, mu.data(), m, q);
+			q += k + 1;
+
+			//r = (x - q * n) mod B^(k + 1), only the low k + 1 limbs of q * n are needed
+			limb_t *qn = frame.get(k + 1);
+			for (size_t i = 0; i < m && i <= k; i++) {
+				limb_t carry = 0;
+				for (size_t j = 0; j < k && i + j <= k; j++)
+					qn[i + j] = mulAdd(q[i], mod[j], qn[i + j], carry);
+				if (i == 0)
+					qn[k] = carry;
+			}
+
+			limb_t borrow = 0;
+			for (size_t i = 0; i <= k; i++)
+				x[i] = subBorrow(x[i], qn[i], borrow);
+
+			while (!lessRaw(x, k)) {
+				borrow = 0;
+				for (size_t i = 0; i < k; i++)
+					x[i] = subBorrow(x[i], mod[i], borrow);
+				x[k] -= borrow;
+			}
+		}
+
+		//x[0 .. k] < n
+		bool lessRaw(const limb_t *x, size_t k) const {
+			if (x[k]) return 0;
+			for (int i = k - 1; i >= 0; i--) {
+				if (x[i] != mod[i])
+					return x[i] < mod[i];
+			}
+			return 0;
+		}
+
+	public:
+		Barrett(const BigInt &n) {
+			if (n <= 0)
+				throw logic_error("Barrett modulus must be positive");
+
+			mod = n.limbs;
+			mu = ((BigInt(1) << (2 * mod.size() * LIMB_BITS)) / n).limbs;
+		}
+
+		BigInt modulus() const {
+			return fromRaw(mod);
+		}
+
+		//x mod n, the fast path needs 0 <= x < B^2k (e.g. a product of two reduced values)
+		BigInt reduce(const BigInt &x) const {
+			const size_t k = mod.size();
+			if (IS_NEGATIVE(x) || x.limbs.size() > 2 * k)
+				return x % modulus();
+
+			Arena::Frame frame;
+			limb_t *r = frame.get(2 * k);
+			copy(x.limbs.begin(), x.limbs.end(), r);
+			reduceRaw(r);
+			return fromRaw(r, k);
+		}
+
+		BigInt mulMod(const BigInt &a, const BigInt &b) const {
+			const size_t k = mod.size();
+			if (IS_NEGATIVE(a) || IS_NEGATIVE(b) || a.limbs.size() > k || b.limbs.size() > k)
+				return reduce(a * b);
+
+			Arena::Frame frame;
+			limb_t *r = frame.get(2 * k);
+			mulRaw(a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size(), r);
+			reduceRaw(r);
+			return fromRaw(r, k);
+		}
+
+		//a ^ b mod n by square and multiply, every step is one product and one reduction in frame scratch
+		BigInt powMod(const BigInt &a, const BigInt &b) const {
+			const size_t k = mod.size();
+			Arena::Frame frame;
+			limb_t *base = frame.get(2 * k);
+			limb_t *y = frame.get(2 * k);
+			limb_t *prod = frame.get(2 * k);
+
+			const BigInt r = reduce(a);
+			copy(r.limbs.begin(), r.limbs.end(), base);
+			y[0] = 1;
+			reduceRaw(y); //n = 1 gives 0
+
+			for (int i = b.bitLength() - 1; i >= 0; i--) {
+				mulRaw(y, k, y, k, prod); // y ^ 2 % n
+				reduceRaw(prod);
+				swap(y, prod);
+				if (b[i]) {
+					mulRaw(y, k, base, k, prod);
+					reduceRaw(prod);
+					swap(y, prod);
+				}
+			}
+			return fromRaw(y, k);
+		}
+	};
+
 	static BigInt addMod(const BigInt &a, const BigInt &b, const BigInt &n) {
 		BigInt tmp = addUnsigned(a, b);
 		if (tmp < n) return tmp;
 		return subUnsinged(tmp, n); //should be tmp % n, but assume tmp wont be too large
 	}
 
-	static BigInt mulMod(BigInt a, const BigInt &b, const BigInt &n) {
-		BigInt P;
-
-		if (b.bits[0])
-			P = a;
-
-		for (int i = 1; i < b.bits.size(); i++) {
-			// a = addMod(a << 1, 0, n); // 2 * a % n
-			a <<= 1;
-			if (a >= n) a = subUnsinged(a, n);
+	static BigInt mulMod(const BigInt &a, const BigInt &b, const BigInt &n) {
+		return (a * b) % n;
+	}
 
-			if (b.bits[i])
-				P = addMod(P, a, n);
+	static BigInt powMod(const BigInt &a, const BigInt &b, const BigInt &n, ExpMode mode = SLIDING_WINDOW) {
+		//one limb modulus, square and multiply on machine words
+		if (n.limbs.size() == 1 && IS_POSITIVE(n) && mode == SLIDING_WINDOW) {
+			const limb_t m = n.limbs[0];
+			limb_t base = modSmall(a, m);
+			if (IS_NEGATIVE(a) && base) base = m - base;
+
+			limb_t y = 1 % m;
+			for (int i = b.bitLength() - 1; i >= 0; i--) {
+				y = mulModWord(y, y, m);
+				if (b[i])
+					y = mulModWord(y, base, m);
+			}
+			BigInt res;
+			if (y) res.limbs.push_back(y);
+			return res;
 		}
-		return P;
-	}
 
-	static BigInt powMod(const BigInt &a, const BigInt &b, const BigInt &n) {
-		BigInt y = 1;
+		if (n[0] && n > 1) {
+			BigInt res;
+			const bool fixed = withFixedWidth(n, [&](auto width) {
+				typedef decltype(width) Fixed;
+				const typename Fixed::Montgomery mont((Fixed)n);
+				res = BigInt(mont.powMod((Fixed)(a % n), b.limbs.data(), b.limbs.size(), mode == FIXED_WINDOW));
+			});
+			if (fixed) return res;
 
-		for (int i = b.bits.size() - 1; i >= 0; i--) {
-			y = mulMod(y, y, n); // y ^ 2 % n
-			if (b.bits[i])
-				y = mulMod(y, a, n);
+			return Montgomery(n).powMod(a, b, mode);
 		}
-		return y;
+
+		//even modulus, Montgomery needs an odd one
+		return Barrett(n).powMod(a, b);
 	}
 
-	static BigInt inverseMod(BigInt a, BigInt n) {
+	//a^-1 mod n, or 0 when gcd(a, n) != 1
+	static BigInt inverseMod(const BigInt &a, const BigInt &n) {
 		if (n == 1)
 			return 0;
-		BigInt n0 = n;
-		BigInt x = 1;
-		BigInt y = 0;
-		while (a > 1) {
-			BigInt q, r;
-			divideUnsigned(a, n, q, r);
-			a = n;
-			n = r;
-			BigInt tmp = y;
-			y = x - q * y;
-			x = tmp;
-		}
-		if (x < 0)
-			x = x + n0;
-		return x;
-	}
-
-	static BigInt gcd(BigInt a, BigInt b) {
-		if (isZero(a)) return b;
-		if (isZero(b)) return a;
 
-		int k = 1;
+		BigInt s;
+		if (lehmerGcd(a % n, n, &s) != 1)
+			return 0;
+		return s % n;
+	}
 
-		int aMsb = firstSetBit(a);
-		if (aMsb < 0) aMsb = 0;
-		int bMsb = firstSetBit(b);
-		if (bMsb < 0) bMsb = 0;
-		const int shareMsb = min(aMsb, bMsb);
+	//a^-1 mod n for odd n > 1 and 0 <= a < n, or 0 when gcd(a, n) != 1.
+	//Binary extended Euclid with a fixed 2 * 64 * limbs(n) iterations and masked
+	//limb operations, so the running time only depends on the size of n.
+	//Use it when a or n is secret, e.g. inverses modulo a private prime
+	static BigInt inverseModConstTime(const BigInt &a, const BigInt &n) {
+		if (!n[0] || n <= 1)
+			throw logic_error("constant time inverse needs an odd modulus");
+
+		const size_t k = n.limbs.size();
+		const BigInt ar = (IS_NEGATIVE(a) || a >= n) ? a % n : a;
+
+		//invariant: u = x1 * a, v = x2 * a (mod n) and v is odd
+		vector<limb_t> u(ar.limbs), v(n.limbs), x1(k, 0), x2(k, 0);
+		u.resize(k, 0);
+		x1[0] = 1;
+
+		for (size_t it = 0; it < 2 * k * LIMB_BITS; it++) {
+			const limb_t odd = 0 - (u[0] & 1);
+
+			//if u is odd and u < v swap (u, x1) with (v, x2)
+			limb_t borrow = 0;
+			for (size_t i = 0; i < k; i++)
+				subBorrow(u[i], v[i], borrow);
+			const limb_t swapMask = odd & (0 - borrow);
+			for (size_t i = 0; i < k; i++) {
+				limb_t t = (u[i] ^ v[i]) & swapMask;
+				u[i] ^= t;
+				v[i] ^= t;
+				t = (x1[i] ^ x2[i]) & swapMask;
+				x1[i] ^= t;
+				x2[i] ^= t;
+			}
 
-		a >>= aMsb;
-		b >>= bMsb;
+			//if u is odd: u -= v, x1 -= x2 (mod n)
+			borrow = 0;
+			for (size_t i = 0; i < k; i++)
+				u[i] = subBorrow(u[i], v[i] & odd, borrow);
+			borrow = 0;
+			for (size_t i = 0; i < k; i++)
+				x1[i] = subBorrow(x1[i], x2[i] & odd, borrow);
+			const limb_t under = 0 - borrow;
+			limb_t carry = 0;
+			for (size_t i = 0; i < k; i++)
+				x1[i] = addCarry(x1[i], n.limbs[i] & under, carry);
+
+			//u is even now: u /= 2, x1 /= 2 (mod n)
+			for (size_t i = 0; i < k; i++)
+				u[i] = (u[i] >> 1) | (i + 1 < k ? u[i + 1] << (LIMB_BITS - 1) : 0);
+			const limb_t half = 0 - (x1[0] & 1);
+			carry = 0;
+			for (size_t i = 0; i < k; i++)
+				x1[i] = addCarry(x1[i], n.limbs[i] & half, carry);
+			for (size_t i = 0; i < k; i++)
+				x1[i] = (x1[i] >> 1) | ((i + 1 < k ? x1[i + 1] : carry) << (LIMB_BITS - 1));
+		}
 
-		while (a != b) {
-			if (a < b)
-				swap(a, b);
+		//u is 0 and v = gcd(a, n)
+		limb_t notOne = v[0] ^ 1;
+		for (size_t i = 1; i < k; i++)
+			notOne |= v[i];
+		if (notOne)
+			return 0;
 
-			a = a - b;
-			while (a % 2 == 0) a >>= 1;
-		}
+		BigInt res;
+		res.limbs = move(x2);
+		res.clean();
+		return res;
+	}
 
-		return a << shareMsb;
+	static BigInt gcd(const BigInt &a, const BigInt &b) {
+		return lehmerGcd(abs(a), abs(b), nullptr);
 	}
 
 	//Comparisions
@@ -532,111 +1693,211 @@ public:
 		return !(*this == other);
 	}
 
-	//Bit Shift
+	//Bit Shift, both directions act on the magnitude and keep the sign
 	BigInt operator<<(int pos) const {
-		BigInt res = *this;
-		while (pos--)
-			res.bits.insert(res.bits.begin(), 0);
+		if (pos <= 0) return *this;
+
+		BigInt res;
+		res.limbs.reserve(limbs.size() + pos / LIMB_BITS + 1);
+		res.limbs.assign(limbs.begin(), limbs.end());
+		res.sign = sign;
+		res <<= pos;
 		return res;
 	}
 
 	BigInt operator>>(int pos) const {
-		BigInt res = *this;
-		while (pos--) {
-			if (res.bits.size() == 0) break;
-			res.bits.erase(res.bits.begin());
+		if (pos <= 0) return *this;
+
+		BigInt res;
+		const size_t words = pos / LIMB_BITS;
+		if (words < limbs.size()) {
+			res.limbs.assign(limbs.begin() + words, limbs.end());
+			res.sign = sign;
+			res >>= pos % LIMB_BITS;
 		}
 		return res;
 	}
 
+	//Whole limbs move with one pass, the remaining bits are funneled between neighbours.
+	//Works top down inside the existing buffer, only growing it when the value gets longer
 	BigInt& operator<<=(int pos) {
-		while (pos--)
-			bits.insert(bits.begin(), 0);
+		if (pos <= 0 || limbs.empty()) return *this;
+
+		const size_t words = pos / LIMB_BITS;
+		const int rem = pos % LIMB_BITS;
+		const int n = limbs.size();
+
+		const limb_t top = rem ? limbs[n - 1] >> (LIMB_BITS - rem) : 0;
+		limbs.resize(n + words + (top != 0));
+		if (top) limbs[n + words] = top;
+
+		for (int i = n - 1; i >= 0; i--) {
+			limb_t low = (rem && i > 0) ? limbs[i - 1] >> (LIMB_BITS - rem) : 0;
+			limbs[i + words] = (limbs[i] << rem) | low;
+		}
+		fill(limbs.begin(), limbs.begin() + words, 0);
+
 		return *this;
 	}
 
+	//Bottom up in place, the buffer only shrinks
 	BigInt& operator>>=(int pos) {
-		while (pos--) {
-			if (bits.size() == 0) break;
-			bits.erase(bits.begin());
+		if (pos <= 0 || limbs.empty()) return *this;
+
+		const size_t words = pos / LIMB_BITS;
+		const int rem = pos % LIMB_BITS;
+
+		if (words >= limbs.size()) {
+			limbs.clear();
+			clean();
+			return *this;
+		}
+
+		const size_t n = limbs.size() - words;
+		for (size_t i = 0; i < n; i++) {
+			limb_t high = (rem && i + words + 1 < limbs.size()) ? limbs[i + words + 1] << (LIMB_BITS - rem) : 0;
+			limbs[i] = (limbs[i + words] >> rem) | high;
 		}
+
+		limbs.resize(n);
+		clean();
 		return *this;
 	}
 
 	bool operator[](int index) const {
-		if (index < bits.size()) return bits[index];
+		size_t w = index / LIMB_BITS;
+		if (w < limbs.size()) return (limbs[w] >> (index % LIMB_BITS)) & 1;
 		return 0;
 	}
 
 	//Identity
-	static bool isZero(BigInt n) {
-		n.clean();
-		return n.bits.size() == 0;
+	static bool isZero(const BigInt &n) {
+		return n.limbs.size() == 0;
+	}
+
+	int bitLength() const {
+		if (limbs.empty()) return 0;
+		return limbs.size() * LIMB_BITS - countLeadingZeros(limbs.back());
 	}
 
 	static int firstSetBit(const BigInt &n) {
-		for (int i = 0; i < n.bits.size(); i++) {
-			if (n.bits[i])
-				return i;
+		for (int i = 0; i < n.limbs.size(); i++) {
+			if (n.limbs[i])
+				return i * LIMB_BITS + countTrailingZeros(n.limbs[i]);
 		}
 		return -1;
 	}
 
 	//return -1 if not, else return MSB index
-	static int isPowerOfTwo(BigInt n) {
+	static int isPowerOfTwo(const BigInt &n) {
 		int cnt = 0;
-		int msb = 0;
-		for (int i = 0; i < n.bits.size(); i++) {
-			if (n.bits[i]) msb = i;
-			cnt += n.bits[i];
+		for (limb_t l : n.limbs) {
+			cnt += popCount(l);
 		}
 		if (cnt != 1) return -1;
-		else return msb;
+		else return n.bitLength() - 1;
 	}
 
 	static bool isPrime(const BigInt &n) {
 		if (n < 2) return 0;
 		if (n == 2) return 1;
 		if (n % 2 == 0) return 0;
+
+		int res = trialDivision(n);
+		if (res != -1) return res;
+
 		return millerRabin(n);
 	}
 
+	//Smallest probable prime >= start. The residues of the candidate modulo the small primes
+	//are computed once and bumped by 2 per step, so only sieve survivors reach Miller-Rabin
+	static BigInt nextPrime(const BigInt &start) {
+		if (start <= 2) return 2;
+
+		BigInt n = start;
+		if (n % 2 == 0) n = n + 1;
+
+		//too close to the sieve primes themselves, a zero residue could be the prime
+		if (n.bitLength() <= 32) {
+			while (!isPrime(n)) n = n + 2;
+			return n;
+		}
+
+		const vector<limb_t> &primes = smallPrimes();
+		vector<limb_t> residues = smallPrimeResidues(n);
+
+		for (long long delta = 0;; delta += 2) {
+			bool survivor = 1;
+			for (size_t i = 0; i < primes.size(); i++) {
+				survivor &= residues[i] != 0;
+				residues[i] += 2;
+				if (residues[i] >= primes[i]) residues[i] -= primes[i];
+			}
+
+			if (survivor) {
+				BigInt candidate = n + delta;
+				if (millerRabin(candidate)) return candidate;
+			}
+		}
+	}
+
+	//isPrime over many candidates, spread over the thread pool when PARALLEL_PRIME_CHECK is set.
+	//Results keep the input order (char instead of bool so workers never share a byte)
+	static vector<char> isPrimeBatch(const vector<BigInt> &candidates) {
+		vector<char> res(candidates.size());
+#ifdef PARALLEL_PRIME_CHECK
+		TaskGroup group;
+		for (size_t i = 0; i < candidates.size(); i++) {
+			group.run([&candidates, &res, i]() {
+				res[i] = isPrime(candidates[i]);
+			});
+		}
+		group.wait();
+#else
+		for (size_t i = 0; i < candidates.size(); i++)
+			res[i] = isPrime(candidates[i]);
+#endif
+		return res;
+	}
+
 	//Utils
 	static BigInt rand(int size, bool enforce_size = 0) {
-		static bool init = 0;
-		static random_device rd;
-		static mt19937 eng;
-		static uniform_int_distribution<int> dist(0,1);
+		//one engine per thread, parallel Miller-Rabin rounds draw bases concurrently
+		static thread_local bool init = 0;
+		static thread_local mt19937_64 eng;
 
 		if (!init) {
-			eng.seed(rd()); //seed once
+			random_device rd;
+			eng.seed(rd()); //seed once per thread
 			init = 1;
 		}
 
 		BigInt res;
-		res.bits.resize(size);
+		if (size <= 0) return res;
 
-		if (enforce_size) size--;
+		res.limbs.resize((size + LIMB_BITS - 1) / LIMB_BITS);
+		for (limb_t &l : res.limbs)
+			l = eng();
 
-		for (int i = 0; i < size; i++)
-			res.bits[i] = dist(eng);
+		if (size % LIMB_BITS)
+			res.limbs.back() &= ((limb_t)1 << (size % LIMB_BITS)) - 1;
 
 		if (enforce_size)
-			res.bits[size] = 1; //Set MSB
+			res.setBit(size - 1); //Set MSB
 
 		res.clean();
 		return res;
 	}
 
 	static BigInt rand(const BigInt &low, const BigInt &high) {
-		BigInt tmp = rand(high.bits.size());
+		BigInt tmp = rand(high.bitLength());
 		return tmp % (high - low) + low;
 	}
 
 	//IO
 	friend ostream& operator<<(ostream &os, const BigInt &n) {
 		const int maxBit = sizeof(long long) * 8 - 1; //63 bit
-		if (n.bits.size() <= maxBit)
+		if (n.bitLength() <= maxBit)
 			os << n.toLongLong();
 		else
 			os << n.toDecString();
@@ -645,52 +1906,46 @@ public:
 
 	long long toLongLong() const {
 		long long res = 0;
-		for (int i = min((size_t)63, bits.size()) - 1; i >= 0; i--)
-			res = (res << 1) | bits[i];
+		if (!limbs.empty())
+			res = limbs[0] & (~(limb_t)0 >> 1); //63 bit
 		if (sign) res *= -1;
 		return res;
 	}
 
 	string toDecString() const {
-		stringstream builder;
-
-		BigInt n = abs(*this);
-		while (n != 0) {
-			BigInt q, r;
-			divideUnsigned(n, 10, q, r);
+		if (isZero(*this)) return "0";
 
-			builder << r.toLongLong();
-			n = q;
+		//smallest level with 10^(19 * 2^(level + 1)) > |n|, i.e. 10^(19 * 2^level) has at least half the limbs
+		int level = -1;
+		if (limbs.size() > DEC_SPLIT_THRESHOLD) {
+			level = 0;
+			while (2 * (decPowers(level + 1)[level].limbs.size() - 1) < limbs.size())
+				level++;
 		}
+		const vector<BigInt> &pows = decPowers(level + 1);
 
-		if (sign) builder << "-";
-
-		string reversed = builder.str();
-		string res(reversed.rbegin(), reversed.rend());
+		//a limb is under 20 digits, at a level the pieces have a fixed width
+		const size_t width = level < 0 ? limbs.size() * (DEC_DIGITS + 1) : (size_t)DEC_DIGITS << (level + 1);
+		string res(sign + width, '0');
+		writeDec(*this, pows, level, &res[0] + res.size());
 
+		//drop the padding, keeping the sign in front
+		const size_t first = res.find_first_not_of('0', sign);
+		res.erase(sign, first - sign);
+		if (sign) res[0] = '-';
 		return res;
 	}
 
+	//first character is the least significant nibble
 	string toHexString(bool displaySign = 0) const {
 		if (isZero(*this)) return "0";
 
-		const char tbl[16] = {
-			'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'
-		};
-
-		stringstream builder;
-
-		if (displaySign && sign) builder << "-";
+		const size_t prefix = displaySign && sign;
+		string res(prefix + limbs.size() * LIMB_NIBBLES, '-');
+		for (size_t i = 0; i < limbs.size(); i++)
+			limbToHex(limbs[i], &res[prefix + i * LIMB_NIBBLES]);
 
-		for (int i = 0; i < bits.size(); i += 4) {
-			char c = 0;
-			c |= (*this)[i + 0] << 0;
-			c |= (*this)[i + 1] << 1;
-			c |= (*this)[i + 2] << 2;
-			c |= (*this)[i + 3] << 3;
-			builder << tbl[c];
-		}
-
-		return builder.str();
+		res.resize(prefix + (bitLength() + 3) / 4);
+		return res;
 	}
 };
\ No newline at end of file
@@ -0,0 +1,402 @@
+#pragma once
+#include <mutex>
+#include <unordered_map>
+#include "ThreadPool.h"
+
+//Largest table baby-step giant-step builds, bigger prime orders go to Pollard rho
+#ifndef BSGS_MAX_BABY_STEPS
+#define BSGS_MAX_BABY_STEPS (1 << 20)
+#endif
+
+//Discrete logarithms modulo an odd p, meant for auditing DH / ElGamal parameters.
+//Include after BigInt.h. Prime subgroup orders must fit in one limb
+class DiscreteLog {
+public:
+	//x with g^x = h (mod p), or -1 when h is not a power of g.
+	//factors are the distinct primes of p - 1; Pohlig-Hellman solves x modulo the q-part of the
+	//order of g for each of them and glues the pieces with the CRT, so x < ord(g)
+	static BigInt solve(const BigInt &g, const BigInt &h, const BigInt &p, const vector<BigInt> &factors) {
+		if (p <= 2 || !p[0])
+			throw logic_error("Discrete log modulus must be an odd prime");
+
+		//0 has no logarithm and is no generator, every power of it past the first stays 0
+		const BigInt gr = g % p;
+		const BigInt hr = h % p;
+		if (gr == 0)
+			throw logic_error("Discrete log base is divisible by p");
+		if (hr == 0) return -1;
+
+		const BigInt n = p - 1;
+		BigInt x = 0, mod = 1, covered = 1;
+
+		for (const BigInt &q : factors) {
+			BigInt qe = 1, rest = n;
+			int e = 0;
+			while (q > 1 && rest % q == 0) {
+				rest = rest / q;
+				qe = qe * q;
+				e++;
+			}
+			if (qe == 1)
+				throw logic_error("Factor does not divide p - 1");
+			covered = covered * qe;
+
+			//g and h pushed into the subgroup of order q^e, where g has order q^f
+			const BigInt gq = BigInt::powMod(gr, n / qe, p);
+			const BigInt hq = BigInt::powMod(hr, n / qe, p);
+
+			//at most e steps, a composite p may leave gq outside every q-power order
+			BigInt qf = 1, t = gq;
+			for (int i = 0; i < e && t != 1; i++) {
+				t = BigInt::powMod(t, q, p);
+				qf = qf * q;
+			}
+			if (t != 1)
+				throw logic_error("Discrete log modulus must be an odd prime");
+			if (BigInt::powMod(hq, qf, p) != 1) return -1;
+			if (qf == 1) continue;
+
+			//one base-q digit of x mod q^f per prime order problem, gamma has order q
+			const BigInt gamma = BigInt::powMod(gq, qf / q, p);
+			BigInt xq = 0, qk = 1;
+			while (qk != qf) {
+				const BigInt shifted = BigInt::mulMod(BigInt::inverseMod(BigInt::powMod(gq, xq, p), p), hq, p);
+				const BigInt hk = BigInt::powMod(shifted, qf / (qk * q), p);
+
+				const BigInt d = solvePrimeOrder(gamma, hk, p, q);
+				if (d < 0) return -1;
+
+				xq = xq + d * qk;
+				qk = qk * q;
+			}
+
+			//x = xq (mod qf) on top of x (mod mod)
+			x = x + mod * ((xq - x) * BigInt::inverseMod(mod, qf) % qf);
+			mod = mod * qf;
+		}
+
+		if (covered != n)
+			throw logic_error("Factors do not cover p - 1");
+
+		x = x % mod;
+		if (BigInt::powMod(gr, x, p) != hr) return -1;
+		return x;
+	}
+
+	//x in [0, q) with g^x = h (mod p) where g has prime order q (or is 1), -1 if there is none
+	static BigInt solvePrimeOrder(const BigInt &g, const BigInt &h, const BigInt &p, const BigInt &q) {
+		if (p <= 2 || !p[0])
+			throw logic_error("Discrete log modulus must be an odd prime");
+		if (q.bitLength() > 64)
+			throw logic_error("Subgroup order does not fit in one limb");
+
+		const BigInt hr = h % p;
+		if (g % p == 1)
+			return hr == 1 ? 0 : -1;
+
+		//<g> is the only subgroup of order q, anything outside it would make rho walk forever
+		if (BigInt::powMod(hr, q, p) != 1)
+			return -1;
+
+		limb_t x;
+		bool found;
+		if (p.bitLength() <= 64)
+			found = solveIn(WordGroup(p), g, hr, p, word(q), x);
+		else
+			found = solveIn(BigGroup(p), g, hr, p, word(q), x);
+
+		if (!found) return -1;
+		return fromWord(x);
+	}
+
+private:
+	//Montgomery arithmetic on a single limb, R = 2^64. Elements are their Montgomery form,
+	//so the key of an element identifies it exactly
+	struct WordGroup {
+		typedef limb_t Element;
+		static const bool exact = true;
+
+		limb_t n, nInv, r1, r2;
+
+		WordGroup(const BigInt &p) {
+			n = word(p);
+			limb_t inv = n;
+			for (int i = 0; i < 5; i++)
+				inv *= 2 - n * inv;
+			nInv = 0 - inv;
+			r1 = word((BigInt(1) << 64) % p);
+			r2 = word((BigInt(1) << 128) % p);
+		}
+
+		limb_t mul(limb_t a, limb_t b) const {
+			limb_t hi = 0;
+			const limb_t lo = mulWide(a, b, hi);
+
+			//(hi:lo + m * n) / 2^64 < 2n, the low word cancels by the choice of m
+			limb_t carry = 0;
+			mulWide(lo * nInv, n, lo, carry);
+			limb_t c = 0;
+			limb_t t = addWord(hi, carry, c);
+			if (c || t >= n) t -= n;
+			return t;
+		}
+
+		void mulInto(Element &a, const Element &b) const {
+			a = mul(a, b);
+		}
+
+		Element one() const {
+			return r1;
+		}
+
+		Element from(const BigInt &a) const {
+			return mul(word(a % fromWord(n)), r2);
+		}
+
+		static limb_t key(Element a) {
+			return a;
+		}
+	};
+
+	//Multi-limb p on the shared Montgomery context. Elements stay unpacked (k limbs, Montgomery
+	//form) so a step is one montMul with no allocation; the key is the lowest limb
+	struct BigGroup {
+		typedef vector<limb_t> Element;
+		static const bool exact = false;
+
+		BigInt::Montgomery mont;
+
+		BigGroup(const BigInt &p) : mont(p) {}
+
+		void mulInto(Element &a, const Element &b) const {
+			static thread_local vector<limb_t> t;
+			t.resize(mont.mod.size() + 2);
+			mont.montMul(a.data(), b.data(), a.data(), t.data());
+		}
+
+		Element one() const {
+			return mont.r1;
+		}
+
+		Element from(const BigInt &a) const {
+			return mont.toRaw(mont.toMont(a));
+		}
+
+		static limb_t key(const Element &a) {
+			return a[0];
+		}
+	};
+
+	//Open addressing (linear probing) from element keys to baby step indices, 12 bytes per slot
+	class BabyStepTable {
+	private:
+		static constexpr uint32_t EMPTY = ~(uint32_t)0;
+
+		vector<limb_t> keys;
+		vector<uint32_t> steps;
+		size_t mask;
+
+		size_t slot(limb_t key) const {
+			return (key * 0x9E3779B97F4A7C15ULL) >> 20 & mask;
+		}
+
+	public:
+		//room for count entries at load factor <= 1/2
+		explicit BabyStepTable(size_t count) {
+			size_t size = 2;
+			while (size < 2 * count) size <<= 1;
+			keys.assign(size, 0);
+			steps.assign(size, EMPTY);
+			mask = size - 1;
+		}
+
+		void insert(limb_t key, uint32_t step) {
+			size_t i = slot(key);
+			while (steps[i] != EMPTY) i = (i + 1) & mask;
+			keys[i] = key;
+			steps[i] = step;
+		}
+
+		//call f(step) for every entry stored under key until it returns 1
+		template <class F>
+		bool find(limb_t key, F f) const {
+			for (size_t i = slot(key); steps[i] != EMPTY; i = (i + 1) & mask) {
+				if (keys[i] == key && f(steps[i]))
+					return 1;
+			}
+			return 0;
+		}
+	};
+
+	//One point of a rho walk, X = g^a * h^b
+	struct Trail {
+		limb_t a, b;
+	};
+
+	//Limb access for the group types
+	static limb_t word(const BigInt &a) {
+		return a.limbs.empty() ? 0 : a.limbs[0];
+	}
+
+	static BigInt fromWord(limb_t w) {
+		BigInt res;
+		if (w) res.limbs.push_back(w);
+		return res;
+	}
+
+	static limb_t mulWide(limb_t a, limb_t b, limb_t c, limb_t &carry) {
+		return BigInt::mulAdd(a, b, c, carry);
+	}
+
+	static limb_t mulWide(limb_t a, limb_t b, limb_t &hi) {
+		return BigInt::mulAdd(a, b, 0, hi);
+	}
+
+	static limb_t addWord(limb_t a, limb_t b, limb_t &carry) {
+		return BigInt::addCarry(a, b, carry);
+	}
+
+	//Exponent arithmetic mod a one limb q
+	static limb_t addMod(limb_t a, limb_t b, limb_t q) {
+		const limb_t s = a + b;
+		return (s < a || s >= q) ? s - q : s;
+	}
+
+	static limb_t mulMod(limb_t a, limb_t b, limb_t q) {
+		return BigInt::mulModWord(a, b, q);
+	}
+
+	template <class Group>
+	static bool solveIn(const Group &G, const BigInt &g, const BigInt &h, const BigInt &p, limb_t q, limb_t &x) {
+		if (q <= (limb_t)BSGS_MAX_BABY_STEPS * BSGS_MAX_BABY_STEPS)
+			return babyStepGiantStep(G, g, h, p, q, x);
+		return pollardRho(G, g, h, p, q, x);
+	}
+
+	//x = i * m + j: baby steps g^j go into the table, giant steps h * g^(-m i) are looked up
+	template <class Group>
+	static bool babyStepGiantStep(const Group &G, const BigInt &g, const BigInt &h, const BigInt &p, limb_t q, limb_t &x) {
+		limb_t m = 1;
+		while (m * m < q) m++;
+
+		BabyStepTable table(m);
+		const typename Group::Element gM = G.from(g);
+		typename Group::Element e = G.one();
+		for (limb_t j = 0; j < m; j++) {
+			table.insert(Group::key(e), (uint32_t)j);
+			G.mulInto(e, gM);
+		}
+
+		const typename Group::Element giant = G.from(BigInt::powMod(g, fromWord(q - m), p));
+		typename Group::Element y = G.from(h);
+
+		for (limb_t i = 0; i * m < q; i++) {
+			const bool hit = table.find(Group::key(y), [&](uint32_t j) {
+				const limb_t candidate = i * m + j;
+				if (candidate >= q) return 0;
+				if (!Group::exact && BigInt::powMod(g, fromWord(candidate), p) != h) return 0;
+				x = candidate;
+				return 1;
+			});
+			if (hit) return 1;
+			G.mulInto(y, giant);
+		}
+		return 0;
+	}
+
+	//Parallel rho (van Oorschot-Wiener): every worker runs 32-adding walks from random g^a h^b
+	//and reports the distinguished points (low key bits zero) to a shared table. Two walks that
+	//reach the same point with different b give x = (a1 - a2) / (b2 - b1) mod q
+	template <class Group>
+	static bool pollardRho(const Group &G, const BigInt &g, const BigInt &h, const BigInt &p, limb_t q, limb_t &x) {
+		typedef typename Group::Element Element;
+		const int PARTITIONS = 32;
+
+		//about 2^16 distinguished points over the expected sqrt(pi q / 2) steps
+		const int expectedBits = (fromWord(q).bitLength() + 1) / 2;
+		const int dpBits = max(0, expectedBits - 16);
+		const limb_t dpMask = ((limb_t)1 << dpBits) - 1;
+		const limb_t maxWalk = (limb_t)20 << dpBits;
+
+		random_device rd;
+		mt19937_64 seeder(((limb_t)rd() << 32) ^ rd());
+		auto randomExponent = [q](mt19937_64 &rng) {
+			return uniform_int_distribution<limb_t>(0, q - 1)(rng);
+		};
+
+		auto element = [&](const Trail &t) {
+			Element X = G.from(BigInt::powMod(g, fromWord(t.a), p));
+			G.mulInto(X, G.from(BigInt::powMod(h, fromWord(t.b), p)));
+			return X;
+		};
+
+		//X -> X * M[s], (a, b) -> (a + A[s], b + B[s]) with s taken from the key of X.
+		//A new walk starts from the last one times a random J[r], which is much cheaper than g^a h^b
+		vector<Element> M(PARTITIONS), J(PARTITIONS);
+		vector<Trail> step(PARTITIONS), jump(PARTITIONS);
+		for (int s = 0; s < PARTITIONS; s++) {
+			step[s] = {randomExponent(seeder), randomExponent(seeder)};
+			jump[s] = {randomExponent(seeder), randomExponent(seeder)};
+			M[s] = element(step[s]);
+			J[s] = element(jump[s]);
+		}
+
+		mutex lock;
+		unordered_map<limb_t, Trail> points;
+		atomic<bool> done{0};
+		limb_t answer = 0;
+
+		//claim answer if (a1, b1) and (a2, b2) land on the same element
+		auto collide = [&](const Trail &u, const Trail &v) {
+			if (u.b == v.b) return;
+			const BigInt inv = BigInt::inverseMod(fromWord(addMod(u.b, q - v.b, q)), fromWord(q));
+			const limb_t candidate = mulMod(addMod(v.a, q - u.a, q), word(inv), q);
+			if (BigInt::powMod(g, fromWord(candidate), p) == h) {
+				answer = candidate;
+				done = 1;
+			}
+		};
+
+		TaskGroup group;
+		const unsigned workers = ThreadPool::global().size();
+		for (unsigned w = 0; w < workers; w++) {
+			const limb_t seed = seeder();
+			group.run([&, seed]() {
+				mt19937_64 rng(seed);
+				Trail t = {randomExponent(rng), randomExponent(rng)};
+				Element X = element(t);
+
+				while (!done) {
+					const int r = rng() % PARTITIONS;
+					G.mulInto(X, J[r]);
+					t.a = addMod(t.a, jump[r].a, q);
+					t.b = addMod(t.b, jump[r].b, q);
+
+					for (limb_t len = 0; len < maxWalk; len++) {
+						const limb_t key = Group::key(X);
+						if ((key & dpMask) == 0) {
+							lock_guard<mutex> guard(lock);
+							auto it = points.find(key);
+							if (it == points.end())
+								points.emplace(key, t);
+							else if (!done)
+								collide(t, it->second);
+							break;
+						}
+
+						const int s = (key * 0x9E3779B97F4A7C15ULL) >> 59;
+						G.mulInto(X, M[s]);
+						t.a = addMod(t.a, step[s].a, q);
+						t.b = addMod(t.b, step[s].b, q);
+
+						if ((len & 1023) == 1023 && done) break;
+					}
+				}
+			});
+		}
+		group.wait();
+
+		x = answer;
+		return done;
+	}
+};
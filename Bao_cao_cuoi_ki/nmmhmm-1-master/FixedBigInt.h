@@ -0,0 +1,346 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(_MSC_VER) && !defined(__SIZEOF_INT128__)
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+typedef uint64_t limb_t;
+
+//Unsigned integer of exactly Bits bits kept in a std::array, for moduli of a known key size
+//(512, 1024, 2048, 4096). Nothing is allocated and every limb loop has a compile time trip
+//count, so the compiler unrolls the carry chains. BigInt converts to and from it explicitly
+template <int Bits>
+class FixedBigInt {
+	static_assert(Bits > 0 && Bits % 64 == 0, "FixedBigInt width must be a multiple of 64 bits");
+
+public:
+	static constexpr int LIMBS = Bits / 64;
+
+	array<limb_t, LIMBS> limbs{}; //little endian, leading zero limbs allowed
+
+	constexpr FixedBigInt() {}
+
+	constexpr explicit FixedBigInt(limb_t x) {
+		limbs[0] = x;
+	}
+
+	//Limb primitives
+	static constexpr limb_t addCarry(limb_t a, limb_t b, limb_t &carry) {
+		limb_t s = a + carry;
+		limb_t c = s < carry;
+		s += b;
+		carry = c | (s < b);
+		return s;
+	}
+
+	static constexpr limb_t subBorrow(limb_t a, limb_t b, limb_t &borrow) {
+		limb_t d = a - b;
+		limb_t c = a < b;
+		limb_t res = d - borrow;
+		borrow = c | (d < borrow);
+		return res;
+	}
+
+	//return low word of a * b + c + carry, high word goes to carry
+	static limb_t mulAdd(limb_t a, limb_t b, limb_t c, limb_t &carry) {
+#ifdef __SIZEOF_INT128__
+		unsigned __int128 t = (unsigned __int128)a * b + c + carry;
+		carry = (limb_t)(t >> 64);
+		return (limb_t)t;
+#else
+		limb_t hi;
+		limb_t lo = _umul128(a, b, &hi);
+		lo += c;
+		hi += lo < c;
+		lo += carry;
+		hi += lo < carry;
+		carry = hi;
+		return lo;
+#endif
+	}
+
+	//res = a + b mod 2^Bits and return the carry out, res may alias a or b
+	static constexpr limb_t add(FixedBigInt &res, const FixedBigInt &a, const FixedBigInt &b) {
+		limb_t carry = 0;
+		for (int i = 0; i < LIMBS; i++)
+			res.limbs[i] = addCarry(a.limbs[i], b.limbs[i], carry);
+		return carry;
+	}
+
+	//res = a - b mod 2^Bits and return the borrow out, res may alias a or b
+	static constexpr limb_t sub(FixedBigInt &res, const FixedBigInt &a, const FixedBigInt &b) {
+		limb_t borrow = 0;
+		for (int i = 0; i < LIMBS; i++)
+			res.limbs[i] = subBorrow(a.limbs[i], b.limbs[i], borrow);
+		return borrow;
+	}
+
+	static constexpr int compare(const FixedBigInt &a, const FixedBigInt &b) {
+		for (int i = LIMBS - 1; i >= 0; i--) {
+			if (a.limbs[i] != b.limbs[i])
+				return a.limbs[i] < b.limbs[i] ? -1 : 1;
+		}
+		return 0;
+	}
+
+	//Math, wraps around modulo 2^Bits
+	constexpr FixedBigInt operator+(const FixedBigInt &other) const {
+		FixedBigInt res;
+		add(res, *this, other);
+		return res;
+	}
+
+	constexpr FixedBigInt operator-(const FixedBigInt &other) const {
+		FixedBigInt res;
+		sub(res, *this, other);
+		return res;
+	}
+
+	//Comparison
+	constexpr bool operator==(const FixedBigInt &other) const {
+		return compare(*this, other) == 0;
+	}
+
+	constexpr bool operator!=(const FixedBigInt &other) const {
+		return compare(*this, other) != 0;
+	}
+
+	constexpr bool operator<(const FixedBigInt &other) const {
+		return compare(*this, other) < 0;
+	}
+
+	constexpr bool operator>(const FixedBigInt &other) const {
+		return compare(*this, other) > 0;
+	}
+
+	constexpr bool operator<=(const FixedBigInt &other) const {
+		return compare(*this, other) <= 0;
+	}
+
+	constexpr bool operator>=(const FixedBigInt &other) const {
+		return compare(*this, other) >= 0;
+	}
+
+	constexpr bool operator[](int index) const {
+		return (limbs[index / 64] >> (index % 64)) & 1;
+	}
+
+	//Montgomery arithmetic for an odd modulus 1 < n < 2^Bits with R = 2^Bits.
+	//Same CIOS product as BigInt::Montgomery, with the width fixed at compile time
+	class Montgomery {
+	private:
+		FixedBigInt mod;
+		FixedBigInt r1; //R mod n
+		FixedBigInt r2; //R^2 mod n
+		limb_t nInv; //-n^-1 mod 2^64
+
+		//return count (<= 64) bits of the little endian number e starting at index
+		static limb_t getBits(const limb_t *e, size_t size, int index, int count) {
+			size_t w = index / 64;
+			int off = index % 64;
+			limb_t res = 0;
+			if (w < size) res = e[w] >> off;
+			if (off && off + count > 64 && w + 1 < size)
+				res |= e[w + 1] << (64 - off);
+			if (count < 64) res &= ((limb_t)1 << count) - 1;
+			return res;
+		}
+
+		static int bitLength(const limb_t *e, size_t size) {
+			while (size && !e[size - 1]) size--;
+			int bits = size * 64;
+			for (limb_t top = size ? e[size - 1] : 0; bits && !(top >> 63); top <<= 1)
+				bits--;
+			return bits;
+		}
+
+		//same thresholds as OpenSSL's BN_window_bits_for_exponent_size
+		static int windowBits(int expBits) {
+			if (expBits > 671) return 6;
+			if (expBits > 239) return 5;
+			if (expBits > 79) return 4;
+			if (expBits > 23) return 3;
+			return 1;
+		}
+
+	public:
+		explicit Montgomery(const FixedBigInt &n) : mod(n) {
+			if (!(n.limbs[0] & 1) || n <= FixedBigInt(1))
+				throw logic_error("Montgomery modulus must be odd and greater than 1");
+
+			//Newton iteration, every step doubles the number of correct low bits (3 -> 96)
+			limb_t inv = mod.limbs[0];
+			for (int i = 0; i < 5; i++)
+				inv *= 2 - mod.limbs[0] * inv;
+			nInv = 0 - inv;
+
+			//R mod n, doubling 1 Bits times
+			r1 = FixedBigInt(1);
+			for (int i = 0; i < Bits; i++) {
+				if (add(r1, r1, r1) || r1 >= mod)
+					sub(r1, r1, mod);
+			}
+
+			//R^2 = (2R)^Bits * R^(1 - Bits), i.e. 2 to the power Bits in Montgomery form
+			FixedBigInt two = r1;
+			if (add(two, two, two) || two >= mod)
+				sub(two, two, mod);
+			const limb_t e = Bits;
+			r2 = exp(two, &e, 1);
+		}
+
+		const FixedBigInt& modulus() const {
+			return mod;
+		}
+
+		//Montgomery form of 1
+		const FixedBigInt& one() const {
+			return r1;
+		}
+
+		//res = a * b * R^-1 mod n (CIOS), a/b/res may alias
+		void mul(const FixedBigInt &a, const FixedBigInt &b, FixedBigInt &res) const {
+			array<limb_t, LIMBS + 2> t{};
+			const limb_t *m = mod.limbs.data();
+
+			for (int i = 0; i < LIMBS; i++) {
+				limb_t carry = 0;
+				for (int j = 0; j < LIMBS; j++)
+					t[j] = mulAdd(a.limbs[j], b.limbs[i], t[j], carry);
+				limb_t c = 0;
+				t[LIMBS] = addCarry(t[LIMBS], carry, c);
+				t[LIMBS + 1] = c;
+
+				const limb_t u = t[0] * nInv;
+				carry = 0;
+				mulAdd(u, m[0], t[0], carry);
+				for (int j = 1; j < LIMBS; j++)
+					t[j - 1] = mulAdd(u, m[j], t[j], carry);
+				c = 0;
+				t[LIMBS - 1] = addCarry(t[LIMBS], carry, c);
+				t[LIMBS] = t[LIMBS + 1] + c;
+			}
+
+			//t < 2n, so subtract n once and keep the difference unless it borrowed (branch free)
+			limb_t borrow = 0;
+			for (int i = 0; i < LIMBS; i++)
+				res.limbs[i] = subBorrow(t[i], m[i], borrow);
+			subBorrow(t[LIMBS], 0, borrow);
+
+			const limb_t mask = borrow - 1;
+			for (int i = 0; i < LIMBS; i++)
+				res.limbs[i] = (res.limbs[i] & mask) | (t[i] & ~mask);
+		}
+
+		//a must be reduced, 0 <= a < n
+		FixedBigInt toMont(const FixedBigInt &a) const {
+			FixedBigInt res;
+			mul(a, r2, res);
+			return res;
+		}
+
+		FixedBigInt fromMont(const FixedBigInt &aM) const {
+			FixedBigInt res;
+			mul(aM, FixedBigInt(1), res);
+			return res;
+		}
+
+		//aM ^ e for the little endian exponent e[0 .. size), input and output in Montgomery form.
+		//fixedWindow reads the whole table on every step (BigInt's FIXED_WINDOW), stop is polled
+		//once per window to abandon the computation early
+		FixedBigInt exp(const FixedBigInt &aM, const limb_t *e, size_t size, bool fixedWindow = 0, const atomic<bool> *stop = nullptr) const {
+			const int bits = bitLength(e, size);
+			const int w = windowBits(bits);
+			FixedBigInt y = r1;
+
+			if (fixedWindow) {
+				//table[i] = a^i for every w-bit digit
+				const int count = 1 << w;
+				array<FixedBigInt, 64> table;
+				table[0] = r1;
+				for (int i = 1; i < count; i++)
+					mul(table[i - 1], aM, table[i]);
+
+				FixedBigInt pick;
+				for (int pos = (bits + w - 1) / w * w - w; pos >= 0; pos -= w) {
+					if (stop && *stop) break;
+					for (int j = 0; j < w; j++)
+						mul(y, y, y);
+
+					const limb_t digit = getBits(e, size, pos, w);
+					pick = FixedBigInt();
+					for (int i = 0; i < count; i++) {
+						const limb_t mask = 0 - (limb_t)((limb_t)i == digit);
+						for (int j = 0; j < LIMBS; j++)
+							pick.limbs[j] |= table[i].limbs[j] & mask;
+					}
+					mul(y, pick, y);
+				}
+				return y;
+			}
+
+			//table[i] = a^(2i + 1), only odd powers are needed since windows end on a set bit
+			array<FixedBigInt, 32> table;
+			table[0] = aM;
+			if (w > 1) {
+				FixedBigInt sq;
+				mul(aM, aM, sq);
+				for (int i = 1; i < (1 << (w - 1)); i++)
+					mul(table[i - 1], sq, table[i]);
+			}
+
+			int i = bits - 1;
+			while (i >= 0) {
+				if (stop && *stop) break;
+				if (!getBits(e, size, i, 1)) {
+					mul(y, y, y);
+					i--;
+					continue;
+				}
+
+				int j = max(i - w + 1, 0);
+				while (!getBits(e, size, j, 1)) j++;
+
+				for (int s = j; s <= i; s++)
+					mul(y, y, y);
+				mul(y, table[getBits(e, size, j, i - j + 1) >> 1], y);
+				i = j - 1;
+			}
+			return y;
+		}
+
+		//a ^ e mod n for reduced a
+		FixedBigInt powMod(const FixedBigInt &a, const limb_t *e, size_t size, bool fixedWindow = 0) const {
+			return fromMont(exp(toMont(a), e, size, fixedWindow));
+		}
+
+		//One Miller-Rabin round on n = modulus, n - 1 = d * 2^s and 1 < base < n - 1.
+		//stop is polled between multiplications, the result is meaningless once it is set
+		bool millerRabinWitness(const limb_t *d, size_t size, int s, const FixedBigInt &base, const atomic<bool> *stop = nullptr) const {
+			FixedBigInt minusOne;
+			sub(minusOne, mod, r1);
+
+			FixedBigInt x = exp(toMont(base), d, size, 0, stop);
+			FixedBigInt y;
+			for (int j = 0; j < s; j++) {
+				if (stop && *stop)
+					return 0;
+				mul(x, x, y);
+				if (y == r1 && x != r1 && x != minusOne)
+					return 0;
+				x = y;
+			}
+			if (y != r1)
+				return 0;
+
+			return 1;
+		}
+	};
+};
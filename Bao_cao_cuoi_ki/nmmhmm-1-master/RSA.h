@@ -1,11 +1,19 @@
+#ifdef PARALLEL_RSA_CRT
+#include "ThreadPool.h"
+#endif
+
 
 class RSA {
 public:
+	struct KeyPair {
+		BigInt n, e, d;
+		BigInt p, q;
+	};
+
 	static bool genPrivateKeyFromPublicKey(const BigInt &p, const BigInt &q, const BigInt &e, BigInt &d) {
 		BigInt phi = (p - 1) * (q - 1);
 
-		if (BigInt::gcd(e, phi) != 1) return 0;
-
+		//inverseMod returns 0 when gcd(e, phi) != 1
 		d = BigInt::inverseMod(e, phi);
 
 		if (d == 0) {
@@ -15,4 +23,95 @@ public:
 
 		return 1;
 	}
+
+	//Fresh key pair whose modulus has exactly bits bits. Below 16 bits there are too few primes
+	//with the top two bits set (4 bits only has 13), so the search would never find p != q
+	static KeyPair generateKeyPair(int bits, const BigInt &e = 65537) {
+		if (bits < 16)
+			throw logic_error("RSA modulus must have at least 16 bits");
+		if (e <= 1 || !e[0])
+			throw logic_error("RSA public exponent must be odd and greater than 1");
+
+		KeyPair key;
+		key.e = e;
+
+		do {
+			key.p = genPrime(bits - bits / 2, e);
+			key.q = genPrime(bits / 2, e);
+		} while (key.p == key.q || !genPrivateKeyFromPublicKey(key.p, key.q, key.e, key.d));
+
+		key.n = key.p * key.q;
+		return key;
+	}
+
+	//Private key in CRT form (PKCS #1): x^d mod n is computed as x^dP mod p and x^dQ mod q,
+	//two exponentiations of half the size, and glued back with Garner's formula.
+	//With PARALLEL_RSA_CRT the two halves run on separate threads
+	class PrivateKey {
+	public:
+		const BigInt n, e, d;
+		const BigInt p, q;
+		const BigInt dP, dQ; //d mod (p - 1), d mod (q - 1)
+		const BigInt qInv; //q^-1 mod p
+
+	private:
+		//Built once per key, every decryption reuses them
+		const BigInt::Montgomery monP, monQ;
+
+		static BigInt privateExponent(const BigInt &p, const BigInt &q, const BigInt &e) {
+			BigInt d;
+			if (p == q || !genPrivateKeyFromPublicKey(p, q, e, d))
+				throw logic_error("Invalid RSA private key");
+			return d;
+		}
+
+		//x^d mod n for 0 <= x < n. The exponents are secret, so both halves use FIXED_WINDOW
+		BigInt power(const BigInt &x) const {
+			BigInt m1, m2;
+#ifdef PARALLEL_RSA_CRT
+			{
+				TaskGroup halves;
+				halves.run([&]() { m1 = monP.powMod(x, dP, BigInt::FIXED_WINDOW); });
+				m2 = monQ.powMod(x, dQ, BigInt::FIXED_WINDOW);
+				halves.wait();
+			}
+#else
+			m1 = monP.powMod(x, dP, BigInt::FIXED_WINDOW);
+			m2 = monQ.powMod(x, dQ, BigInt::FIXED_WINDOW);
+#endif
+
+			//Garner: m = m2 + q * (qInv * (m1 - m2) mod p)
+			const BigInt m2p = m2 % p;
+			const BigInt h = monP.mulMod(qInv, m1 >= m2p ? m1 - m2p : m1 + p - m2p);
+			return m2 + h * q;
+		}
+
+	public:
+		PrivateKey(const BigInt &p, const BigInt &q, const BigInt &e)
+			: n(p * q), e(e), d(privateExponent(p, q, e)), p(p), q(q),
+			  dP(d % (p - 1)), dQ(d % (q - 1)), qInv(BigInt::inverseModConstTime(q % p, p)),
+			  monP(p), monQ(q) {}
+
+		PrivateKey(const KeyPair &key) : PrivateKey(key.p, key.q, key.e) {}
+
+		BigInt decrypt(const BigInt &c) const {
+			return power(c);
+		}
+
+		BigInt sign(const BigInt &m) const {
+			return power(m);
+		}
+	};
+
+private:
+	//Random prime of exactly bits bits with gcd(p - 1, e) = 1. The top two bits are set
+	//so the product of two such primes never comes out one bit short
+	static BigInt genPrime(int bits, const BigInt &e) {
+		const BigInt top = BigInt(3) << (bits - 2);
+		while (1) {
+			BigInt p = BigInt::nextPrime(BigInt::rand(bits - 2) + top);
+			if (p.bitLength() == bits && BigInt::gcd(p - 1, e) == 1)
+				return p;
+		}
+	}
 };
\ No newline at end of file
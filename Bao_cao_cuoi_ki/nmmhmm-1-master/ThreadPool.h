@@ -0,0 +1,177 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+//Work stealing pool. Every worker owns a deque, pops its newest task from the back
+//and steals the oldest task of another worker from the front when it runs dry.
+//Threads that wait on a TaskGroup help by running queued tasks, so groups can nest.
+class ThreadPool {
+private:
+	struct Queue {
+		mutex lock;
+		deque<function<void()>> tasks;
+	};
+
+	vector<unique_ptr<Queue>> queues;
+	vector<thread> workers;
+	atomic<unsigned> nextQueue{0};
+	atomic<int> queued{0};
+	bool stopping = 0;
+	mutex sleepLock;
+	condition_variable wake;
+
+	static int &workerIndex() {
+		static thread_local int idx = -1;
+		return idx;
+	}
+
+	bool popBack(unsigned i, function<void()> &task) {
+		Queue &q = *queues[i];
+		lock_guard<mutex> guard(q.lock);
+		if (q.tasks.empty()) return 0;
+		task = move(q.tasks.back());
+		q.tasks.pop_back();
+		queued--;
+		return 1;
+	}
+
+	bool popFront(unsigned i, function<void()> &task) {
+		Queue &q = *queues[i];
+		lock_guard<mutex> guard(q.lock);
+		if (q.tasks.empty()) return 0;
+		task = move(q.tasks.front());
+		q.tasks.pop_front();
+		queued--;
+		return 1;
+	}
+
+	void workerLoop(unsigned i) {
+		workerIndex() = i;
+		while (1) {
+			if (runOne()) continue;
+
+			unique_lock<mutex> lk(sleepLock);
+			wake.wait(lk, [this]() { return stopping || queued > 0; });
+			if (stopping && queued == 0) return;
+		}
+	}
+
+public:
+	explicit ThreadPool(unsigned threads = thread::hardware_concurrency()) {
+		if (threads == 0) threads = 1;
+		for (unsigned i = 0; i < threads; i++)
+			queues.emplace_back(new Queue());
+		for (unsigned i = 0; i < threads; i++)
+			workers.emplace_back([this, i]() { workerLoop(i); });
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool() {
+		{
+			lock_guard<mutex> guard(sleepLock);
+			stopping = 1;
+		}
+		wake.notify_all();
+		for (thread &t: workers) {
+			t.join();
+		}
+	}
+
+	//Pool shared by the library, one worker per hardware thread
+	static ThreadPool& global() {
+		static ThreadPool pool;
+		return pool;
+	}
+
+	unsigned size() const {
+		return workers.size();
+	}
+
+	void submit(function<void()> task) {
+		int idx = workerIndex();
+		unsigned i = idx >= 0 ? idx : nextQueue++ % queues.size();
+		{
+			lock_guard<mutex> guard(queues[i]->lock);
+			queues[i]->tasks.push_back(move(task));
+		}
+		queued++;
+		{
+			lock_guard<mutex> guard(sleepLock);
+		}
+		wake.notify_one();
+	}
+
+	//Run one queued task on the calling thread, return 0 if there was nothing to do
+	bool runOne() {
+		function<void()> task;
+		int idx = workerIndex();
+		bool found = idx >= 0 && popBack(idx, task);
+		for (unsigned k = 0; !found && k < queues.size(); k++)
+			found = popFront((idx + 1 + k) % queues.size(), task);
+		if (!found) return 0;
+
+		task();
+		return 1;
+	}
+};
+
+//A set of tasks that can be waited on together and cancelled cooperatively:
+//tasks that have not started yet are skipped, running ones should poll cancelled
+class TaskGroup {
+private:
+	ThreadPool &pool;
+	atomic<int> pending{0};
+	mutex doneLock;
+	condition_variable done;
+
+public:
+	atomic<bool> cancelled{0};
+
+	explicit TaskGroup(ThreadPool &pool = ThreadPool::global()) : pool(pool) {}
+
+	TaskGroup(const TaskGroup&) = delete;
+
+	TaskGroup& operator=(const TaskGroup&) = delete;
+
+	~TaskGroup() {
+		wait();
+	}
+
+	void run(function<void()> f) {
+		pending++;
+		pool.submit([this, f]() {
+			if (!cancelled) f();
+			//the last decrement happens under the lock, so wait() cannot return
+			//(and the group be destroyed) before this task lets go of it
+			lock_guard<mutex> guard(doneLock);
+			if (--pending == 0)
+				done.notify_all();
+		});
+	}
+
+	void cancel() {
+		cancelled = 1;
+	}
+
+	void wait() {
+		while (pending > 0) {
+			if (pool.runOne()) continue;
+
+			unique_lock<mutex> lk(doneLock);
+			done.wait_for(lk, chrono::microseconds(200), [this]() { return pending == 0; });
+		}
+		lock_guard<mutex> guard(doneLock);
+	}
+};
\ No newline at end of file
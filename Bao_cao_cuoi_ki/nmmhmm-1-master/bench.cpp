@@ -0,0 +1,48 @@
+#include "BigInt.h"
+#include <chrono>
+#include <iomanip>
+using namespace std;
+
+//Average time of one top level product in microseconds
+double timeMul(const BigInt &a, const BigInt &b, BigInt::MulAlgorithm algo) {
+	int reps = 1;
+	while (true) {
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < reps; i++)
+			BigInt::multiply(a, b, algo);
+		double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+		if (us > 20000) return us / reps;
+		reps *= 2;
+	}
+}
+
+int main() {
+	const int sizes[] = {8, 12, 16, 20, 24, 32, 40, 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 512};
+
+	int karatsuba = -1;
+	int toom3 = -1;
+
+	cout << "limbs" << setw(14) << "schoolbook" << setw(14) << "karatsuba" << setw(14) << "toom3" << endl;
+
+	for (int n : sizes) {
+		BigInt a = BigInt::rand(n * 64, 1);
+		BigInt b = BigInt::rand(n * 64, 1);
+
+		double school = timeMul(a, b, BigInt::MUL_SCHOOLBOOK);
+		double kara = timeMul(a, b, BigInt::MUL_KARATSUBA);
+		double toom = timeMul(a, b, BigInt::MUL_TOOM3);
+
+		cout << setw(5) << n << fixed << setprecision(2)
+			<< setw(14) << school << setw(14) << kara << setw(14) << toom << endl;
+
+		if (karatsuba == -1 && kara < school) karatsuba = n;
+		if (toom3 == -1 && karatsuba != -1 && toom < kara) toom3 = n;
+	}
+
+	cout << endl;
+	cout << "Suggested flags: -DKARATSUBA_THRESHOLD=" << karatsuba
+		<< " -DTOOM3_THRESHOLD=" << toom3 << endl;
+	cout << "(current: " << KARATSUBA_THRESHOLD << ", " << TOOM3_THRESHOLD << ")" << endl;
+
+	return 0;
+}
\ No newline at end of file
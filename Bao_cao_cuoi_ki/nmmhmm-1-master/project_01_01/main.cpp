@@ -8,18 +8,22 @@ int main(int argc, char const *argv[]) {
 		exit(1);
 	}
 
+	//One candidate per line, a file with a single number behaves as before
 	ifstream inp(argv[1]);
+	vector<BigInt> nums;
 	string line;
-	inp >> line;
+	while (inp >> line)
+		nums.push_back(BigInt(line));
 
-	BigInt num(line);
-
-	bool res = BigInt::isPrime(num);
+	vector<char> res = BigInt::isPrimeBatch(nums);
 
 	ofstream out(argv[2]);
-	out << res << endl;
+	for (size_t i = 0; i < res.size(); i++) {
+		out << (int)res[i] << "\n";
+
+		if (i) cout << "\n";
+		cout << (int)res[i];
+	}
 
-	cout << res;
-	
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include <fstream>
+#include "../BigInt.h"
+#include "../DiscreteLog.h"
+
+//p, factor count n, n distinct primes of p - 1, g, h -> smallest x with g^x = h (mod p), or -1
+int main(int argc, char const *argv[]) {
+	if (argc < 3) {
+		cout << argv[0] << " <input file> <output file>" << endl;
+		exit(1);
+	}
+
+	ifstream inp(argv[1]);
+	string line;
+
+	inp >> line;
+	BigInt p(line);
+
+	inp >> line;
+	BigInt n(line);
+
+	vector<BigInt> factors;
+	for (long long i = 0; i < n.toLongLong(); i++) {
+		inp >> line;
+		factors.push_back(BigInt(line));
+	}
+
+	inp >> line;
+	BigInt g(line);
+
+	inp >> line;
+	BigInt h(line);
+
+	//bad parameters (g = 0 mod p, factors that do not fit p - 1) have no logarithm either
+	BigInt x;
+	try {
+		x = DiscreteLog::solve(g, h, p, factors);
+	}
+	catch (const logic_error &e) {
+		cerr << e.what() << endl;
+		x = -1;
+	}
+
+	ofstream out(argv[2]);
+
+	if (x >= 0) {
+		cout << x.toHexString();
+		out << x.toHexString() << endl;
+	}
+	else {
+		cout << -1;
+		out << -1 << endl;
+	}
+
+	return 0;
+}
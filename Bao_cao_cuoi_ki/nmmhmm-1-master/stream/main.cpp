@@ -0,0 +1,315 @@
+#include <fstream>
+#include <cctype>
+#include <exception>
+#include "../BigInt.h"
+#include "../RSA.h"
+#include "../ThreadPool.h"
+
+//One process for any number of problems: records are read back to back from a file or stdin,
+//each record holds the same tokens as a test_XX.inp of its project (little endian hex).
+//Batches of records run on the thread pool and the answers are written in input order
+
+typedef vector<BigInt> Record;
+
+//Records per pool task, cheap problems (small modexp) would drown in scheduling otherwise
+const size_t RECORDS_PER_TASK = 16;
+
+//Records read ahead while the previous batch is being solved
+const size_t RECORDS_PER_BATCH = 4096;
+
+//Whitespace separated tokens, pulled from the stream in large blocks
+class TokenReader {
+private:
+	istream &in;
+	vector<char> buf;
+	size_t pos = 0;
+	size_t len = 0;
+
+	bool fill() {
+		len = in.rdbuf()->sgetn(buf.data(), buf.size());
+		pos = 0;
+		return len > 0;
+	}
+
+public:
+	explicit TokenReader(istream &in) : in(in), buf(1 << 16) {}
+
+	//return 0 once the input has no more tokens
+	bool next(string &token) {
+		token.clear();
+		while (1) {
+			if (pos == len && !fill())
+				return !token.empty();
+
+			if (isspace((unsigned char)buf[pos])) {
+				pos++;
+				if (!token.empty()) return 1;
+				continue;
+			}
+
+			const size_t start = pos;
+			while (pos < len && !isspace((unsigned char)buf[pos])) pos++;
+			token.append(&buf[start], pos - start);
+		}
+	}
+
+	//next count tokens into rec, return 0 at a clean end of input and throw on a cut off record
+	bool read(Record &rec, size_t count) {
+		string token;
+		for (size_t i = 0; i < count; i++) {
+			if (!next(token)) {
+				if (i == 0) return 0;
+				throw logic_error("Truncated record");
+			}
+			rec.push_back(BigInt(token));
+		}
+		return 1;
+	}
+};
+
+//Collects answers and hands them to the stream in large writes
+class BufferedWriter {
+private:
+	ostream &out;
+	string buf;
+
+public:
+	explicit BufferedWriter(ostream &out) : out(out) {}
+
+	BufferedWriter(const BufferedWriter&) = delete;
+
+	BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+	~BufferedWriter() {
+		flush();
+	}
+
+	void write(const string &s) {
+		buf += s;
+		if (buf.size() >= (1 << 20))
+			flush();
+	}
+
+	void flush() {
+		out.write(buf.data(), buf.size());
+		out.flush();
+		buf.clear();
+	}
+};
+
+//Record readers, return 0 at the end of input
+bool readFixed1(TokenReader &in, Record &rec) { return in.read(rec, 1); }
+bool readFixed3(TokenReader &in, Record &rec) { return in.read(rec, 3); }
+bool readFixed4(TokenReader &in, Record &rec) { return in.read(rec, 4); }
+bool readFixed5(TokenReader &in, Record &rec) { return in.read(rec, 5); }
+bool readFixed6(TokenReader &in, Record &rec) { return in.read(rec, 6); }
+
+//p, factor count n, n prime factors of p - 1, g
+bool readPrimitiveRoot(TokenReader &in, Record &rec) {
+	if (!in.read(rec, 2)) return 0;
+	const BigInt count = rec[1];
+	if (count.bitLength() > 31)
+		throw logic_error("Too many factors");
+	if (!in.read(rec, count.toLongLong() + 1))
+		throw logic_error("Truncated record");
+	return 1;
+}
+
+//Solvers, one answer line per output value as in the test_XX.out files
+
+//project_01_01: n -> 1 if n is prime
+string solvePrime(const Record &r) {
+	return BigInt::isPrime(r[0]) ? "1\n" : "0\n";
+}
+
+//project_01_02: p q e -> d = e^-1 mod phi(n), or -1
+string solveRsa(const Record &r) {
+	BigInt d;
+	if (!RSA::genPrivateKeyFromPublicKey(r[0], r[1], r[2], d))
+		return "-1\n";
+	return d.toHexString() + "\n";
+}
+
+//project_01_03: N k x -> x^k mod N
+string solveModExp(const Record &r) {
+	if (r[0] <= 0)
+		throw logic_error("Invalid modulus");
+	return BigInt::powMod(r[2], r[1], r[0]).toHexString() + "\n";
+}
+
+//project_02_01: p n q1 .. qn g -> 1 if g^((p - 1) / q) != 1 for every q
+string solvePrimitiveRoot(const Record &r) {
+	const BigInt &p = r[0];
+	const BigInt &g = r.back();
+	if (g <= 1 || g >= p)
+		return "0\n";
+
+	const BigInt order = p - 1;
+	for (size_t i = 2; i + 1 < r.size(); i++) {
+		if (r[i] <= 1)
+			throw logic_error("Invalid factor");
+		if (BigInt::powMod(g, order / r[i], p) == 1)
+			return "0\n";
+	}
+	return "1\n";
+}
+
+//project_02_02: p g a b -> g^a, g^b and the shared key g^(ab)
+string solveDiffieHellman(const Record &r) {
+	const BigInt &p = r[0];
+	if (p <= 1)
+		throw logic_error("Invalid modulus");
+
+	const BigInt A = BigInt::powMod(r[1], r[2], p);
+	const BigInt B = BigInt::powMod(r[1], r[3], p);
+	const BigInt K = BigInt::powMod(A, r[3], p);
+	return A.toHexString() + "\n" + B.toHexString() + "\n" + K.toHexString() + "\n";
+}
+
+//project_02_03: p g x c1 c2 -> public key g^x and m = c2 * (c1^x)^-1
+string solveElGamalDecrypt(const Record &r) {
+	const BigInt &p = r[0];
+	if (p <= 1)
+		throw logic_error("Invalid modulus");
+
+	const BigInt y = BigInt::powMod(r[1], r[2], p);
+	const BigInt s = BigInt::powMod(r[3], r[2], p);
+	const BigInt m = BigInt::mulMod(r[4], BigInt::inverseMod(s, p), p);
+	return y.toHexString() + "\n" + m.toHexString() + "\n";
+}
+
+//project_02_04: p g y m r s -> 1 if 0 < r < p and g^m = y^r * r^s
+string solveElGamalVerify(const Record &r) {
+	const BigInt &p = r[0];
+	if (p <= 1)
+		throw logic_error("Invalid modulus");
+	if (r[4] <= 0 || r[4] >= p)
+		return "0\n";
+
+	const BigInt lhs = BigInt::powMod(r[1], r[3], p);
+	const BigInt rhs = BigInt::mulMod(BigInt::powMod(r[2], r[4], p), BigInt::powMod(r[4], r[5], p), p);
+	return lhs == rhs ? "1\n" : "0\n";
+}
+
+struct Problem {
+	const char *project;
+	const char *name;
+	bool (*read)(TokenReader&, Record&);
+	string (*solve)(const Record&);
+};
+
+const Problem problems[] = {
+	{"01_01", "prime", readFixed1, solvePrime},
+	{"01_02", "rsa", readFixed3, solveRsa},
+	{"01_03", "modexp", readFixed3, solveModExp},
+	{"02_01", "primroot", readPrimitiveRoot, solvePrimitiveRoot},
+	{"02_02", "dh", readFixed4, solveDiffieHellman},
+	{"02_03", "elgamal-decrypt", readFixed5, solveElGamalDecrypt},
+	{"02_04", "elgamal-verify", readFixed6, solveElGamalVerify}
+};
+
+//up to RECORDS_PER_BATCH records, fewer only at the end of input.
+//A bad record ends the batch early, the records before it are kept and error is set
+void readBatch(const Problem &problem, TokenReader &in, vector<Record> &batch, exception_ptr &error) {
+	batch.clear();
+	try {
+		while (batch.size() < RECORDS_PER_BATCH) {
+			Record rec;
+			if (!problem.read(in, rec)) break;
+			batch.push_back(move(rec));
+		}
+	}
+	catch (...) {
+		error = current_exception();
+	}
+}
+
+int main(int argc, char const *argv[]) {
+	const Problem *problem = nullptr;
+	for (const Problem &p : problems) {
+		if (argc >= 2 && (string(argv[1]) == p.project || string(argv[1]) == p.name))
+			problem = &p;
+	}
+
+	if (!problem || argc > 4) {
+		cout << argv[0] << " <problem> [input file] [output file]" << endl;
+		cout << "problems:";
+		for (const Problem &p : problems)
+			cout << " " << p.project << "|" << p.name;
+		cout << endl << "a missing file or - means stdin/stdout" << endl;
+		exit(1);
+	}
+
+	ios::sync_with_stdio(0);
+
+	ifstream inpFile;
+	if (argc >= 3 && string(argv[2]) != "-") {
+		inpFile.open(argv[2], ios::binary);
+		if (!inpFile) {
+			cerr << "Cannot open " << argv[2] << endl;
+			exit(1);
+		}
+	}
+
+	ofstream outFile;
+	if (argc >= 4 && string(argv[3]) != "-") {
+		outFile.open(argv[3], ios::binary);
+		if (!outFile) {
+			cerr << "Cannot open " << argv[3] << endl;
+			exit(1);
+		}
+	}
+
+	TokenReader in(inpFile.is_open() ? (istream&)inpFile : cin);
+	BufferedWriter out(outFile.is_open() ? (ostream&)outFile : cout);
+
+	size_t done = 0;
+	vector<Record> batch, next;
+	vector<string> answers;
+	vector<exception_ptr> errors;
+	exception_ptr readError, nextError;
+
+	try {
+		readBatch(*problem, in, batch, readError);
+		while (!batch.empty()) {
+			answers.assign(batch.size(), string());
+			errors.assign(batch.size(), nullptr);
+
+			TaskGroup group;
+			for (size_t i = 0; i < batch.size(); i += RECORDS_PER_TASK) {
+				group.run([&, i]() {
+					for (size_t j = i; j < min(i + RECORDS_PER_TASK, batch.size()); j++) {
+						try {
+							answers[j] = problem->solve(batch[j]);
+						}
+						catch (...) {
+							errors[j] = current_exception();
+						}
+					}
+				});
+			}
+
+			//parse the next batch while the workers solve this one, nothing follows a bad record
+			next.clear();
+			if (!readError)
+				readBatch(*problem, in, next, nextError);
+			group.wait();
+
+			for (size_t j = 0; j < batch.size(); j++, done++) {
+				if (errors[j]) rethrow_exception(errors[j]);
+				out.write(answers[j]);
+			}
+
+			swap(batch, next);
+			if (!readError) swap(readError, nextError);
+		}
+		if (readError) rethrow_exception(readError);
+	}
+	catch (const exception &e) {
+		out.flush();
+		cerr << "Record " << done + 1 << ": " << e.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
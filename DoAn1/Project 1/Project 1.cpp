@@ -1,5 +1,8 @@
 ﻿#include<iostream>
 #include<string>
+#include<algorithm>
+#include<cstdint>
+#include<stdexcept>
 #include<sstream>
 #include<iostream>
 #include<fstream>
@@ -8,30 +11,40 @@
 
 class BigInt {
 private:
-    std::string _num;
+    static const uint32_t BASE = 1000000000;
+    static const int BASE_DIGITS = 9;
+
+    std::vector<uint32_t> _limbs; // base 10^9, least significant limb first, no leading zero limbs
     bool _negative;
 private:
-    int _charIntToInt(char) const;
-    char _intToChar(int) const;
-    std::string _reverse(const std::string&) const;
-    std::string _removeLeadingZeros(const std::string&) const;
-    void _addLeadingZeros(std::string&, int) const;
-    void _addTrailingZeros(std::string&, int) const;
+    void _trim();
+    bool _isZero() const;
+    void _parseDigits(const std::string&);
+    std::string _toString() const;
     bool _validate(const std::string&);
     bool _isNegative(const std::string&);
     std::string _absolute(const std::string&);
+    static int _compareAbs(const BigInt&, const BigInt&);
+    static void _addAbsInPlace(std::vector<uint32_t>&, const std::vector<uint32_t>&);
+    static void _subAbsInPlace(std::vector<uint32_t>&, const std::vector<uint32_t>&, bool);
+    static void _mulAbsInto(std::vector<uint32_t>&, const std::vector<uint32_t>&, const std::vector<uint32_t>&);
+    static void _mulSmall(std::vector<uint32_t>&, uint32_t);
+    static uint32_t _divSmall(std::vector<uint32_t>&, uint32_t);
+    static void _divModLimbs(const std::vector<uint32_t>&, const std::vector<uint32_t>&, std::vector<uint32_t>*, std::vector<uint32_t>&);
 public:
     BigInt();
     BigInt(const std::string&);
     BigInt(const std::string&, bool);
     BigInt(const BigInt&);
-    void operator=(const BigInt&);
+    BigInt(BigInt&&) noexcept;
+    BigInt& operator=(const BigInt&);
+    BigInt& operator=(BigInt&&) noexcept;
     ~BigInt();
 public:
     bool isNegative() const;
 public:
     void setNegative(bool);
-    char& operator[](const int);
+    char operator[](const int) const;
     bool operator<(const BigInt&) const;
     bool operator<(const std::string&) const;
     bool operator>(const BigInt&) const;
@@ -46,23 +59,23 @@ public:
     bool operator>=(const std::string&) const;
     BigInt operator+(const BigInt&) const;
     BigInt operator+(const std::string&) const;
-    void operator+=(const BigInt&);
-    void operator+=(const std::string&);
+    BigInt& operator+=(const BigInt&);
+    BigInt& operator+=(const std::string&);
     BigInt operator-(const BigInt&) const;
     BigInt operator-(const std::string&) const;
-    void operator-=(const BigInt&);
-    void operator-=(const std::string&);
+    BigInt& operator-=(const BigInt&);
+    BigInt& operator-=(const std::string&);
     BigInt operator*(const BigInt&) const;
     BigInt operator*(const std::string&) const;
-    void operator*=(const BigInt&);
-    void operator*=(const std::string&);
+    BigInt& operator*=(const BigInt&);
+    BigInt& operator*=(const std::string&);
     std::tuple<BigInt, BigInt> operator/(const BigInt&) const;
     std::tuple<BigInt, BigInt> operator/(const std::string&) const;
-    void operator /=(const BigInt&);
-    void operator /=(const std::string&);
+    BigInt& operator /=(const BigInt&);
+    BigInt& operator /=(const std::string&);
     BigInt operator%(const BigInt&) const;
     BigInt operator%(const std::string&) const;
-    void operator%=(const BigInt&);
+    BigInt& operator%=(const BigInt&);
 public:
     static BigInt max(const BigInt&, const BigInt&);
     static BigInt modularAddition(const BigInt&, const BigInt&, const BigInt&);
@@ -77,94 +90,67 @@ public:
 };
 
 /**
- * @brief Convert a char to int.
- *
- * @param c char
- * @return int
- */
-int BigInt::_charIntToInt(char c) const {
-    return c - '0';
-}
-
-/**
- * @brief Convert an int to char.
- *
- * @param num int
- * @return char
+ * @brief Remove leading zero limbs, zero is never negative.
  */
-char BigInt::_intToChar(int num) const {
-    return num + '0';
+void BigInt::_trim() {
+    while (!_limbs.empty() && _limbs.back() == 0) {
+        _limbs.pop_back();
+    }
+    if (_limbs.empty()) {
+        _negative = false;
+    }
 }
 
-/**
- * @brief Reverse a string.
- *
- * @param str const std::string&
- * @return std::string
- */
-std::string BigInt::_reverse(const std::string& str) const {
-    return std::string(str.rbegin(), str.rend());
+bool BigInt::_isZero() const {
+    return _limbs.empty();
 }
 
 /**
- * @brief Remove leading zeros (00123 => 123)
+ * @brief Load a string of decimal digits (leading zeros allowed), 9 digits per limb.
  *
- * @param  num const std::string&
- * @return std::string
+ * @param digits const std::string&
  */
-std::string BigInt::_removeLeadingZeros(const std::string& num) const {
-    std::stringstream ss;
-    bool valid = false;
-
-    for (int i = 0; i < (int)num.length(); ++i) {
-        if (num[i] == '0' && !valid) {
-            continue;
-        }
-        else {
-            valid = true;
-            ss << num[i];
+void BigInt::_parseDigits(const std::string& digits) {
+    _limbs.clear();
+    _limbs.reserve(digits.length() / BASE_DIGITS + 1);
+
+    // Cắt từ phải sang trái, mỗi đoạn 9 chữ số
+    for (int end = (int)digits.length(); end > 0; end -= BASE_DIGITS) {
+        int begin = std::max(0, end - BASE_DIGITS);
+        uint32_t limb = 0;
+        for (int i = begin; i < end; ++i) {
+            limb = limb * 10 + (digits[i] - '0');
         }
+        _limbs.push_back(limb);
     }
 
-    if (ss.str().length() == 0) {
-        ss << 0;
-    }
-
-    return ss.str();
+    _trim();
 }
 
 /**
- * @brief Add leading zeros (123, zeros = 4 => 0000123)
+ * @brief Decimal digits of the absolute value (123 => "123", 0 => "0").
  *
- * @param num std::string&
- * @param totalZeros int
+ * @return std::string
  */
-void BigInt::_addLeadingZeros(std::string& num, int totalZeros) const {
-    std::stringstream ss;
-
-    for (int i = 1; i <= totalZeros; ++i) {
-        ss << 0;
+std::string BigInt::_toString() const {
+    if (_isZero()) {
+        return "0";
     }
-    ss << num;
-
-    num = ss.str();
-}
 
-/**
- * @brief Add trailing zeros (123, zeros = 4 => 1230000)
- *
- * @param num std::string&
- * @param totalZeros int
- */
-void BigInt::_addTrailingZeros(std::string& num, int totalZeros) const {
-    std::stringstream ss;
+    std::string str = std::to_string(_limbs.back());
+    str.reserve(str.length() + (_limbs.size() - 1) * BASE_DIGITS);
 
-    ss << num;
-    for (int i = 1; i <= totalZeros; ++i) {
-        ss << 0;
+    char buf[BASE_DIGITS];
+    for (int i = (int)_limbs.size() - 2; i >= 0; --i) {
+        uint32_t limb = _limbs[i];
+        for (int k = BASE_DIGITS - 1; k >= 0; --k) {
+            buf[k] = '0' + limb % 10;
+            limb /= 10;
+        }
+        str.append(buf, BASE_DIGITS);
     }
 
-    num = ss.str();
+    return str;
 }
 
 /**
@@ -204,10 +190,227 @@ std::string BigInt::_absolute(const std::string& num) {
     return num.substr(1, num.length() - 1);
 }
 
+/**
+ * @brief Compare |a| and |b|.
+ *
+ * @return int -1, 0 or 1
+ */
+int BigInt::_compareAbs(const BigInt& a, const BigInt& b) {
+    if (a._limbs.size() != b._limbs.size()) {
+        return (a._limbs.size() < b._limbs.size()) ? -1 : 1;
+    }
+
+    for (int i = (int)a._limbs.size() - 1; i >= 0; --i) {
+        if (a._limbs[i] != b._limbs[i]) {
+            return (a._limbs[i] < b._limbs[i]) ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief x += y in place (x and y may be the same vector)
+ */
+void BigInt::_addAbsInPlace(std::vector<uint32_t>& x, const std::vector<uint32_t>& y) {
+    if (x.size() < y.size()) {
+        x.resize(y.size(), 0);
+    }
+
+    uint32_t carry = 0;
+    size_t i = 0;
+    for (; i < y.size(); ++i) {
+        uint32_t sum = x[i] + y[i] + carry;
+        carry = sum >= BASE;
+        x[i] = carry ? sum - BASE : sum;
+    }
+    for (; carry && i < x.size(); ++i) {
+        uint32_t sum = x[i] + carry;
+        carry = sum >= BASE;
+        x[i] = carry ? sum - BASE : sum;
+    }
+    if (carry) {
+        x.push_back(carry);
+    }
+}
+
+/**
+ * @brief x = x - y (requires x >= y), or x = y - x when reverse is set (requires y >= x).
+ * Works in place, x and y may be the same vector.
+ */
+void BigInt::_subAbsInPlace(std::vector<uint32_t>& x, const std::vector<uint32_t>& y, bool reverse) {
+    if (x.size() < y.size()) {
+        x.resize(y.size(), 0);
+    }
+
+    int64_t borrow = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        int64_t yi = (i < y.size()) ? y[i] : 0;
+        if (!reverse && i >= y.size() && !borrow) break;
+
+        int64_t diff = reverse ? yi - x[i] - borrow : x[i] - yi - borrow;
+        borrow = diff < 0;
+        x[i] = (uint32_t)(borrow ? diff + BASE : diff);
+    }
+
+    while (!x.empty() && x.back() == 0) {
+        x.pop_back();
+    }
+}
+
+/**
+ * @brief out = |a| * |b|, schoolbook on 10^9 limbs with 64-bit accumulators.
+ * out must not be a or b, its capacity is reused.
+ */
+void BigInt::_mulAbsInto(std::vector<uint32_t>& out, const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    out.clear();
+    if (a.empty() || b.empty()) {
+        return;
+    }
+
+    out.resize(a.size() + b.size(), 0);
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < b.size(); ++j) {
+            uint64_t cur = out[i + j] + (uint64_t)a[i] * b[j] + carry;
+            out[i + j] = (uint32_t)(cur % BASE);
+            carry = cur / BASE;
+        }
+        out[i + b.size()] = (uint32_t)carry;
+    }
+
+    while (!out.empty() && out.back() == 0) {
+        out.pop_back();
+    }
+}
+
+/**
+ * @brief x *= m in place, m < 10^9
+ */
+void BigInt::_mulSmall(std::vector<uint32_t>& x, uint32_t m) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        uint64_t cur = (uint64_t)x[i] * m + carry;
+        x[i] = (uint32_t)(cur % BASE);
+        carry = cur / BASE;
+    }
+    if (carry > 0) {
+        x.push_back((uint32_t)carry);
+    }
+}
+
+/**
+ * @brief x /= d in place, d < 10^9
+ *
+ * @return uint32_t remainder
+ */
+uint32_t BigInt::_divSmall(std::vector<uint32_t>& x, uint32_t d) {
+    uint64_t rem = 0;
+    for (int i = (int)x.size() - 1; i >= 0; --i) {
+        uint64_t cur = rem * BASE + x[i];
+        x[i] = (uint32_t)(cur / d);
+        rem = cur % d;
+    }
+    while (!x.empty() && x.back() == 0) {
+        x.pop_back();
+    }
+    return (uint32_t)rem;
+}
+
+/**
+ * @brief a = q * b + r with 0 <= r < b (Knuth 4.3.1 Algorithm D in base 10^9).
+ * q may be null when only the remainder is needed. r may be the same vector as a or b,
+ * the working copies live in per-thread buffers so repeated calls do not allocate.
+ */
+void BigInt::_divModLimbs(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b,
+    std::vector<uint32_t>* q, std::vector<uint32_t>& r) {
+    static thread_local std::vector<uint32_t> u, v;
+
+    if (a.size() < b.size() || (a.size() == b.size() && std::lexicographical_compare(
+        a.rbegin(), a.rend(), b.rbegin(), b.rend()))) {
+        r = a;
+        if (q) q->clear();
+        return;
+    }
+
+    if (b.size() == 1) {
+        const uint32_t d = b[0];
+        u = a;
+        uint32_t rem = _divSmall(u, d);
+        if (q) q->swap(u);
+        r.clear();
+        if (rem > 0) {
+            r.push_back(rem);
+        }
+        return;
+    }
+
+    // Chuẩn hóa để limb cao nhất của số chia >= BASE / 2
+    const uint32_t norm = BASE / (b.back() + 1);
+    const int n = (int)b.size();
+    const int m = (int)a.size() - n;
+    u = a;
+    v = b;
+    _mulSmall(u, norm);
+    _mulSmall(v, norm);
+    u.resize(a.size() + 1, 0);
+
+    if (q) q->assign(m + 1, 0);
+
+    for (int j = m; j >= 0; --j) {
+        uint64_t num = (uint64_t)u[j + n] * BASE + u[j + n - 1];
+        uint64_t qhat = num / v[n - 1];
+        uint64_t rhat = num % v[n - 1];
+
+        while (qhat >= BASE || qhat * v[n - 2] > rhat * BASE + u[j + n - 2]) {
+            --qhat;
+            rhat += v[n - 1];
+            if (rhat >= BASE) break;
+        }
+
+        // u[j .. j + n] -= qhat * v
+        uint64_t carry = 0;
+        int64_t borrow = 0;
+        for (int i = 0; i < n; ++i) {
+            uint64_t prod = qhat * v[i] + carry;
+            carry = prod / BASE;
+            int64_t diff = (int64_t)u[i + j] - (int64_t)(prod % BASE) - borrow;
+            borrow = diff < 0;
+            u[i + j] = (uint32_t)(borrow ? diff + BASE : diff);
+        }
+        int64_t top = (int64_t)u[j + n] - (int64_t)carry - borrow;
+
+        if (top < 0) {
+            // qhat lớn hơn 1, cộng lại v
+            --qhat;
+            uint32_t c = 0;
+            for (int i = 0; i < n; ++i) {
+                uint32_t sum = u[i + j] + v[i] + c;
+                c = sum >= BASE;
+                u[i + j] = c ? sum - BASE : sum;
+            }
+            top += c;
+        }
+        u[j + n] = (uint32_t)top;
+
+        if (q) (*q)[j] = (uint32_t)qhat;
+    }
+
+    if (q) {
+        while (!q->empty() && q->back() == 0) {
+            q->pop_back();
+        }
+    }
+
+    u.resize(n);
+    _divSmall(u, norm);
+    r = u;
+}
+
 BigInt::BigInt() {
     // Do nothing
     _negative = false;
-    _num = "0";
 }
 
 BigInt::BigInt(const std::string& num) {
@@ -217,31 +420,46 @@ BigInt::BigInt(const std::string& num) {
 
     _negative = _isNegative(num);
 
-    _num = (_negative) ? _removeLeadingZeros(_absolute(num)) : _removeLeadingZeros(num);
+    _parseDigits(_negative ? _absolute(num) : num);
 }
 
 BigInt::BigInt(const std::string& num, bool negative) {
-    _num = _removeLeadingZeros(num);
     _negative = negative;
+    _parseDigits(num);
 }
 
 BigInt::BigInt(const BigInt& num) {
-    _num = num._num;
+    _limbs = num._limbs;
     _negative = num._negative;
 }
 
+BigInt::BigInt(BigInt&& num) noexcept {
+    _limbs = std::move(num._limbs);
+    _negative = num._negative;
+    num._negative = false;
+}
+
 /**
  * @brief Set the number's sign (negative or not)
  *
  * @param negativity bool | true = negative, false = positive.
  */
 void BigInt::setNegative(bool negativity) {
-    _negative = negativity;
+    _negative = negativity && !_isZero();
+}
+
+BigInt& BigInt::operator=(const BigInt& num) {
+    // vector::operator= tái sử dụng bộ nhớ đã cấp phát nếu đủ chỗ
+    _limbs = num._limbs;
+    _negative = num._negative;
+    return *this;
 }
 
-void BigInt::operator=(const BigInt& num) {
-    _num = num._num;
+BigInt& BigInt::operator=(BigInt&& num) noexcept {
+    _limbs = std::move(num._limbs);
     _negative = num._negative;
+    num._negative = false;
+    return *this;
 }
 
 BigInt::~BigInt() {
@@ -252,11 +470,30 @@ bool BigInt::isNegative() const {
     return _negative;
 }
 
-char& BigInt::operator[](const int index) {
-    if (index < 0 || index >(int)_num.length()) {
+/**
+ * @brief Decimal digit at index, counted from the most significant digit.
+ *
+ * @param index const int
+ * @return char '0'..'9'
+ */
+char BigInt::operator[](const int index) const {
+    int topDigits = 1;
+    if (!_isZero()) {
+        for (uint32_t t = _limbs.back(); t >= 10; t /= 10) ++topDigits;
+    }
+    const int length = topDigits + (_isZero() ? 0 : ((int)_limbs.size() - 1) * BASE_DIGITS);
+
+    if (index < 0 || index >= length) {
         throw std::runtime_error("Index out of bound");
     }
-    return _num[index];
+    if (_isZero()) {
+        return '0';
+    }
+
+    const int pos = length - 1 - index;
+    uint32_t limb = _limbs[pos / BASE_DIGITS];
+    for (int k = 0; k < pos % BASE_DIGITS; ++k) limb /= 10;
+    return '0' + limb % 10;
 }
 
 bool BigInt::operator<(const BigInt& num) const {
@@ -265,13 +502,9 @@ bool BigInt::operator<(const BigInt& num) const {
         return isNegative();
     }
 
-    // 2 số có độ dài khác nhau => tùy vào dấu mà đưa ra số nhỏ hơn.
-    if (_num.length() != num._num.length()) {
-        return (isNegative()) ? (_num.length() > num._num.length())
-            : (_num.length() < num._num.length());
-    }
-
-    return isNegative() ? (_num > num._num) : (_num < num._num);
+    // Cùng dấu => so sánh trị tuyệt đối, đảo chiều nếu là số âm
+    int cmp = _compareAbs(*this, num);
+    return isNegative() ? (cmp > 0) : (cmp < 0);
 }
 
 bool BigInt::operator<(const std::string& num) const {
@@ -279,7 +512,7 @@ bool BigInt::operator<(const std::string& num) const {
 }
 
 bool BigInt::operator>(const BigInt& num) const {
-    return !(*this <= num);
+    return num < *this;
 }
 
 bool BigInt::operator>(const std::string& num) const {
@@ -287,7 +520,7 @@ bool BigInt::operator>(const std::string& num) const {
 }
 
 bool BigInt::operator==(const BigInt& num) const {
-    return (_num == num._num) && (_negative == num._negative);
+    return (_negative == num._negative) && (_limbs == num._limbs);
 }
 
 bool BigInt::operator==(const std::string& num) const {
@@ -303,7 +536,7 @@ bool BigInt::operator!=(const std::string& num) const {
 }
 
 bool BigInt::operator<=(const BigInt& num) const {
-    return (*this == num || *this < num);
+    return !(num < *this);
 }
 
 bool BigInt::operator<=(const std::string& num) const {
@@ -311,176 +544,85 @@ bool BigInt::operator<=(const std::string& num) const {
 }
 
 bool BigInt::operator>=(const BigInt& num) const {
-    return (*this == num || *this > num);
+    return !(*this < num);
 }
 
 bool BigInt::operator>=(const std::string& num) const {
-    return *this >= num;
+    return *this >= BigInt(num);
 }
 
 BigInt BigInt::operator+(const BigInt& num) const {
-    // Xét dấu phép cộng. Đơn giản là khác dấu => chuyển sang phép trừ, cùng dấu => mang dấu chung.
-    if (isNegative() != num.isNegative()) {
-        return isNegative() ? num - BigInt(_num, !isNegative()) : *this - BigInt(num._num, !num.isNegative());
-    }
+    BigInt result(*this);
+    result += num;
+    return result;
+}
 
-    std::stringstream ss;
+BigInt BigInt::operator+(const std::string& num) const {
+    return *this + BigInt(num);
+}
 
-    std::string firstNum = _num;
-    std::string secondNum = num._num;
+BigInt& BigInt::operator+=(const BigInt& num) {
+    const bool numNegative = num.isNegative();
 
-    // Thêm số 0 vào trước để 2 string bằng nhau => tránh index out of bound.
-    if ((int)_num.length() > (int)secondNum.length()) {
-        _addLeadingZeros(secondNum, (int)(firstNum.length() - secondNum.length()));
-    }
-    else if ((int)_num.length() < (int)secondNum.length()) {
-        _addLeadingZeros(firstNum, (int)(secondNum.length() - firstNum.length()));
+    // Cùng dấu => cộng trị tuyệt đối, giữ nguyên dấu.
+    if (isNegative() == numNegative) {
+        _addAbsInPlace(_limbs, num._limbs);
+        return *this;
     }
 
-    // Cộng như hồi tiểu học (từ phải sang trái)
-    int carry = 0;
-    for (int i = (int)firstNum.length() - 1; i >= 0; --i) {
-        int currentSum = _charIntToInt(firstNum[i]) + _charIntToInt(secondNum[i]) + carry;
-
-        ss << currentSum % 10;
-        carry = currentSum / 10;
+    // Khác dấu => lấy trị tuyệt đối lớn hơn trừ số còn lại, mang dấu của số lớn hơn.
+    if (_compareAbs(*this, num) >= 0) {
+        _subAbsInPlace(_limbs, num._limbs, false);
     }
-
-    if (carry > 0) {
-        while (carry > 0) {
-            ss << carry % 10;
-            carry /= 10;
-        }
+    else {
+        _subAbsInPlace(_limbs, num._limbs, true);
+        _negative = numNegative;
     }
-
-    return BigInt(_reverse(ss.str()), isNegative());
+    _trim();
+    return *this;
 }
 
-BigInt BigInt::operator+(const std::string& num) const {
-    return *this + BigInt(num);
+BigInt& BigInt::operator+=(const std::string& num) {
+    return *this += BigInt(num);
 }
 
-void BigInt::operator+=(const BigInt& num) {
-    // Goes brrr
-    *this = *this + num;
+BigInt BigInt::operator-(const BigInt& num) const {
+    BigInt result(*this);
+    result -= num;
+    return result;
 }
 
-void BigInt::operator+=(const std::string& num) {
-    *this += BigInt(num);
+BigInt BigInt::operator-(const std::string& num) const {
+    return *this - BigInt(num);
 }
 
-BigInt BigInt::operator-(const BigInt& num) const {
-    // Xét dấu phép trừ:
-    // a > 0, b < 0 aka a - (-b): trả về a + b
-    // a < 0, b > 0 aka -a - b: trả về -(a + b)
-    if (isNegative() != num.isNegative()) {
-        BigInt result = BigInt(_num) + BigInt(num._num);
-        result.setNegative(isNegative());
-        return result;
-    }
+BigInt& BigInt::operator-=(const BigInt& num) {
+    // a - b = a + (-b), chỉ khác ở dấu của b
+    const bool numNegative = !num.isNegative() && !num._isZero();
 
-    // Nếu cả 2 số đều âm thì lấy num - *this. Hay là, (-a) - (-b) = b - a.
-    if (isNegative() && num.isNegative()) {
-        return BigInt(num._num) - BigInt(_num);
-    }
-
-    // Các trường hợp trừ 0 và 0 trừ.
-    if (num == "0") {
+    if (isNegative() == numNegative) {
+        _addAbsInPlace(_limbs, num._limbs);
         return *this;
     }
 
-    if (_num == "0" && num != "0") {
-        BigInt result = num;
-        result.setNegative(!num.isNegative());
-        return result;
-    }
-
-    // Trường hợp còn lại - 2 số nguyên dương trừ nhau.
-    std::stringstream ss;
-
-    std::string firstNum = _num;
-    std::string secondNum = num._num;
-
-    // Thêm số 0 vào trước để 2 string bằng nhau => tránh index out of bound.
-    if ((int)_num.length() > (int)secondNum.length()) {
-        _addLeadingZeros(secondNum, (int)(firstNum.length() - secondNum.length()));
-    }
-    else if ((int)_num.length() < (int)secondNum.length()) {
-        _addLeadingZeros(firstNum, (int)(secondNum.length() - firstNum.length()));
-    }
-
-    // Swap order if firstNum < secondNum
-    if (*this < num) {
-        std::swap(firstNum, secondNum);
+    if (_compareAbs(*this, num) >= 0) {
+        _subAbsInPlace(_limbs, num._limbs, false);
     }
-
-    // Reverse both of strings
-    firstNum = _reverse(firstNum);
-    secondNum = _reverse(secondNum);
-
-    int carry = 0;
-
-    for (int i = 0; i < (int)firstNum.length(); i++) {
-        int sub = _charIntToInt(firstNum[i]) - _charIntToInt(secondNum[i]) - carry;
-        if (sub < 0) {
-            sub += 10;
-            carry = 1;
-        }
-        else {
-            carry = 0;
-        }
-        ss << sub;
+    else {
+        _subAbsInPlace(_limbs, num._limbs, true);
+        _negative = numNegative;
     }
-
-    return BigInt(_reverse(ss.str()), (*this < num));
+    _trim();
+    return *this;
 }
 
-
-
-BigInt BigInt::operator-(const std::string& num) const {
-    return *this - BigInt(num);
-}
-
-void BigInt::operator-=(const BigInt& num) {
-    *this = *this - num;
-}
-
-void BigInt::operator-=(const std::string& num) {
-    *this -= BigInt(num);
+BigInt& BigInt::operator-=(const std::string& num) {
+    return *this -= BigInt(num);
 }
 
 BigInt BigInt::operator*(const BigInt& num) const {
-    std::stringstream ss;
-
-    std::string firstNum = _num;
-    std::string secondNum = num._num;
-
-    if (firstNum == "0" || secondNum == "0") {
-        return BigInt("0");
-    }
-
     BigInt result;
-
-    int carry = 0;
-    for (int i = (int)secondNum.length() - 1; i >= 0; --i) {
-        if (secondNum[i] == '0') continue;
-        for (int j = (int)firstNum.length() - 1; j >= 0; --j) {
-            int current_prod = _charIntToInt(firstNum[j]) * _charIntToInt(secondNum[i]) + carry;
-
-            ss << current_prod % 10;
-            carry = current_prod / 10;
-        }
-
-        while (carry > 0) {
-            ss << carry % 10;
-            carry /= 10;
-        }
-
-        std::string lineResult = _reverse(ss.str());
-        _addTrailingZeros(lineResult, secondNum.length() - i - 1);
-
-        result += BigInt(lineResult); ss.str("");
-    }
+    _mulAbsInto(result._limbs, _limbs, num._limbs);
 
     // Result sign
     result.setNegative(isNegative() != num.isNegative());
@@ -492,89 +634,83 @@ BigInt BigInt::operator*(const std::string& num) const {
     return *this * BigInt(num);
 }
 
-void BigInt::operator*=(const BigInt& num) {
-    // Goes brrr
-    *this = *this * num;
+BigInt& BigInt::operator*=(const BigInt& num) {
+    // Nhân vào bộ đệm tạm rồi đổi chỗ, bộ nhớ cũ của *this trở thành bộ đệm cho lần sau
+    static thread_local std::vector<uint32_t> product;
+
+    _mulAbsInto(product, _limbs, num._limbs);
+    _limbs.swap(product);
+    setNegative(isNegative() != num.isNegative());
+    return *this;
 }
 
-void BigInt::operator*=(const std::string& num) {
-    *this *= BigInt(num);
+BigInt& BigInt::operator*=(const std::string& num) {
+    return *this *= BigInt(num);
 }
 
 /**
- * @note Thuật tham khảo từ Tài liệu giáo khoa chuyên tin, quyển 1
- *
- * (c) thầy Hồ Sĩ Đàm, Đỗ Đức Đông, Lê Minh Hoàng, Nguyễn Thanh Hùng.
+ * @brief Division of the absolute values.
  *
  * @param  num const BigInt&
  * @return std::tuple<quotient, remainder>
  */
 std::tuple<BigInt, BigInt> BigInt::operator/(const BigInt& num) const {
-    BigInt zero("0");
-
-    if (num == zero) {
+    if (num._isZero()) {
         throw std::runtime_error("Zero divison");
     }
 
-    std::vector<BigInt> kb(11, zero);
-
-    for (int i = 1; i <= 10; ++i) {
-        kb[i] = kb[i - 1] + num;
-    }
-
-    BigInt c(zero);
-    std::string hold = "";
-
-    for (int i = 0; i < (int)_num.length(); ++i) {
-        hold = hold + _num[i];
+    BigInt q, r;
+    _divModLimbs(_limbs, num._limbs, &q._limbs, r._limbs);
 
-        int k = 0;
-        for (; kb[k] <= hold; ++k);
-
-        c._num += _intToChar(k - 1);
-
-        hold = (BigInt(hold) - kb[k - 1])._num;
-    }
-
-    c._num = _removeLeadingZeros(c._num);
-
-    return std::make_tuple(BigInt(c), BigInt(hold));
+    return std::make_tuple(std::move(q), std::move(r));
 }
 
 std::tuple<BigInt, BigInt> BigInt::operator/(const std::string& num) const {
     return *this / BigInt(num);
 }
 
-void BigInt::operator/=(const BigInt& num) {
-    *this = std::get<0>(*this / num);
+BigInt& BigInt::operator/=(const BigInt& num) {
+    if (num._isZero()) {
+        throw std::runtime_error("Zero divison");
+    }
+
+    static thread_local std::vector<uint32_t> rem;
+
+    _divModLimbs(_limbs, num._limbs, &_limbs, rem);
+    _negative = false;
+    return *this;
 }
 
-void BigInt::operator/=(const std::string& num) {
-    *this /= BigInt(num);
+BigInt& BigInt::operator/=(const std::string& num) {
+    return *this /= BigInt(num);
 }
 
-/**
- * @note Thuật tham khảo từ Tài liệu giáo khoa chuyên tin, quyển 1
- *
- * (c) thầy Hồ Sĩ Đàm, Đỗ Đức Đông, Lê Minh Hoàng, Nguyễn Thanh Hùng.
- */
 BigInt BigInt::operator%(const BigInt& base) const {
-    auto result = *this / base;
-
-    if (*this < "0") {
-        return base - std::get<1>(result);
-    }
-
-    return std::get<1>(*this / base);
+    BigInt result(*this);
+    result %= base;
+    return result;
 }
 
 BigInt BigInt::operator%(const std::string& base) const {
     return *this % BigInt(base);
 }
 
-void BigInt::operator%=(const BigInt& num) {
-    // Goes brrr
-    *this = *this % num;
+BigInt& BigInt::operator%=(const BigInt& num) {
+    if (num._isZero()) {
+        throw std::runtime_error("Zero divison");
+    }
+
+    const bool negative = isNegative();
+
+    _divModLimbs(_limbs, num._limbs, nullptr, _limbs);
+    _negative = false;
+
+    // Số âm: kết quả là num - (|a| mod num), tính bằng -(r - num)
+    if (negative && !_isZero()) {
+        *this -= num;
+        setNegative(!isNegative());
+    }
+    return *this;
 }
 
 /**
@@ -597,15 +733,15 @@ BigInt BigInt::max(const BigInt& a, const BigInt& b) {
  * @return BigInt
  */
 BigInt BigInt::modularAddition(const BigInt& a, const BigInt& b, const BigInt& m) {
-    BigInt zero("0");
-
-    if (m <= zero) {
+    if (m.isNegative() || m._isZero()) {
         throw std::runtime_error("Invalid modular base");
     }
 
-    BigInt first = (a >= zero) ? a : (m - a);
-    BigInt second = (b >= zero) ? b : (m - b);
-    return ((first % m) + (second % m)) % m;
+    BigInt result = a.isNegative() ? m - a : a;
+    result %= m;
+    result += b.isNegative() ? m - b : b;
+    result %= m;
+    return result;
 }
 
 /**
@@ -617,15 +753,22 @@ BigInt BigInt::modularAddition(const BigInt& a, const BigInt& b, const BigInt& m
  * @return BigInt
  */
 BigInt BigInt::modularMultiplication(const BigInt& a, const BigInt& b, const BigInt& m) {
-    BigInt zero("0");
-
-    if (m <= zero) {
+    if (m.isNegative() || m._isZero()) {
         throw std::runtime_error("Invalid modular base");
     }
 
-    BigInt first = (a >= zero) ? a : m - a;
-    BigInt second = (b >= zero) ? b : m - b;
-    return ((first % m) * (second % m)) % m;
+    BigInt result = a.isNegative() ? m - a : a;
+    result %= m;
+
+    // b đã nằm trong [0, m) thì nhân thẳng, không cần bản sao
+    if (!b.isNegative() && _compareAbs(b, m) < 0) {
+        result *= b;
+    }
+    else {
+        result *= (b.isNegative() ? m - b : b) % m;
+    }
+    result %= m;
+    return result;
 }
 
 /**
@@ -697,7 +840,7 @@ std::ostream& operator<<(std::ostream& out, const BigInt& num) {
     if (num.isNegative()) {
         out << '-';
     }
-    out << num._num;
+    out << num._toString();
     return out;
 }
 
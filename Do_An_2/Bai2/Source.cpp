@@ -1,25 +1,34 @@
 #include <iostream>
 #include <fstream>
-#include <sstream>
-#include <iomanip>
-
-// Function to calculate (base^exp) % mod
-long long modPow(long long base, long long exp, long long mod) {
-    long long result = 1;
-    base = base % mod;
-    while (exp > 0) {
-        if (exp % 2 == 1) {
-            result = (result * base) % mod;
-        }
-        exp = exp >> 1;
-        base = (base * base) % mod;
-    }
-    return result;
-}
+#include <string>
+
+// Multi-precision engine shared with the RSA project: little-endian hex I/O,
+// 128-bit word path for one limb moduli and Montgomery above that
+#include "../../Bao_cao_cuoi_ki/nmmhmm-1-master/BigInt.h"
+#include "../../Bao_cao_cuoi_ki/nmmhmm-1-master/ThreadPool.h"
 
 // Function to perform Diffie-Hellman key exchange
-long long diffieHellman(long long base, long long prime, long long private_key) {
-    return modPow(base, private_key, prime);
+BigInt diffieHellman(const BigInt& base, const BigInt& prime, const BigInt& private_key) {
+    return BigInt::powMod(base, private_key, prime);
+}
+
+// Computes A = g^a, B = g^b and K = g^(ab) mod p on separate workers.
+// K does not wait for A: if g^(p-1) = 1 the order of g divides p - 1 and
+// K = g^(ab mod (p-1)), checked alongside. Otherwise K = A^b afterwards.
+void keyExchange(const BigInt& p, const BigInt& g, const BigInt& a, const BigInt& b,
+                 BigInt& A, BigInt& B, BigInt& K) {
+    const BigInt order = p - 1;
+    BigInt shortcut, fermat;
+    {
+        TaskGroup group;
+        group.run([&]() { A = diffieHellman(g, p, a); });
+        group.run([&]() { B = diffieHellman(g, p, b); });
+        group.run([&]() { shortcut = diffieHellman(g, p, (a * b) % order); });
+        group.run([&]() { fermat = diffieHellman(g, p, order); });
+        group.wait();
+    }
+
+    K = (fermat == 1) ? shortcut : diffieHellman(A, p, b);
 }
 
 int main(int argc, char* argv[]) {
@@ -36,19 +45,24 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Read input values from the file
-    long long p, g, a, b;
-    input_file >> std::hex >> p >> g >> a >> b;
+    // Read input values from the file, little-endian hex
+    std::string p_hex, g_hex, a_hex, b_hex;
+    input_file >> p_hex >> g_hex >> a_hex >> b_hex;
+
+    BigInt p(p_hex), g(g_hex), a(a_hex), b(b_hex);
+    if (p <= 1) {
+        std::cerr << "Invalid modulus." << std::endl;
+        return 1;
+    }
 
     // Calculate public keys and shared secret
-    long long A = diffieHellman(g, p, a);
-    long long B = diffieHellman(g, p, b);
-    long long K = diffieHellman(A, p, b);
+    BigInt A, B, K;
+    keyExchange(p, g, a, b, A, B, K);
 
     // Write output to the file
-    output_file << std::hex << std::uppercase << A << std::endl;
-    output_file << std::hex << std::uppercase << B << std::endl;
-    output_file << std::hex << std::uppercase << K << std::endl;
+    output_file << A.toHexString() << std::endl;
+    output_file << B.toHexString() << std::endl;
+    output_file << K.toHexString() << std::endl;
 
     // Close files
     input_file.close();
@@ -1,43 +1,61 @@
 ﻿
 
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
 
 #include <iostream>
+#include <random>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 #include <tuple>
 #include <vector>
 
 class BigInt {
 private:
+    static const uint32_t BASE = 1000000000;
+    static const int BASE_DIGITS = 9;
+
     bool _negative;
-    std::string _num;
-
-    int _charIntToInt(char c) const;
-    char _intToChar(int num) const;
-    std::string _reverse(const std::string& str) const;
-    std::string _removeLeadingZeros(const std::string& num) const;
-    void _addLeadingZeros(std::string& num, int totalZeros) const;
-    void _addTrailingZeros(std::string& num, int totalZeros) const;
+    std::vector<uint32_t> _limbs; // base 10^9, least significant limb first, no leading zero limbs
+
+    void _trim();
+    bool _isZero() const;
+    void _parseDigits(const std::string& digits);
+    std::string _toString() const;
     bool _validate(const std::string& num);
     bool _isNegative(const std::string& num);
     std::string _absolute(const std::string& num);
 
+    static int _compareAbs(const BigInt& a, const BigInt& b);
+    static int _compareLimbs(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+    static void _addAbsInPlace(std::vector<uint32_t>& x, const std::vector<uint32_t>& y);
+    static void _subAbsInPlace(std::vector<uint32_t>& x, const std::vector<uint32_t>& y, bool reverse);
+    static void _mulAbsInto(std::vector<uint32_t>& out, const std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+    static void _mulSmall(std::vector<uint32_t>& x, uint32_t m);
+    static uint32_t _divSmall(std::vector<uint32_t>& x, uint32_t d);
+    static void _divModLimbs(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b,
+        std::vector<uint32_t>* q, std::vector<uint32_t>& r);
+    static void _barrettReduce(std::vector<uint32_t>& x, const std::vector<uint32_t>& m, const std::vector<uint32_t>& mu);
+
 public:
     BigInt();
     BigInt(const std::string& num);
     BigInt(const std::string& num, bool negative);
     BigInt(const BigInt& num);
+    BigInt(BigInt&& num) noexcept;
 
     void setNegative(bool negativity);
 
-    void operator=(const BigInt& num);
+    BigInt& operator=(const BigInt& num);
+    BigInt& operator=(BigInt&& num) noexcept;
 
     ~BigInt();
 
     bool isNegative() const;
 
-    char& operator[](const int index);
+    char operator[](const int index) const;
 
     bool operator<(const BigInt& num) const;
     bool operator<(const std::string& num) const;
@@ -60,32 +78,32 @@ public:
     BigInt operator+(const BigInt& num) const;
     BigInt operator+(const std::string& num) const;
 
-    void operator+=(const BigInt& num);
-    void operator+=(const std::string& num);
+    BigInt& operator+=(const BigInt& num);
+    BigInt& operator+=(const std::string& num);
 
     BigInt operator-(const BigInt& num) const;
     BigInt operator-(const std::string& num) const;
 
-    void operator-=(const BigInt& num);
-    void operator-=(const std::string& num);
+    BigInt& operator-=(const BigInt& num);
+    BigInt& operator-=(const std::string& num);
 
     BigInt operator*(const BigInt& num) const;
     BigInt operator*(const std::string& num) const;
 
-    void operator*=(const BigInt& num);
-    void operator*=(const std::string& num);
+    BigInt& operator*=(const BigInt& num);
+    BigInt& operator*=(const std::string& num);
 
     std::tuple<BigInt, BigInt> operator/(const BigInt& num) const;
     std::tuple<BigInt, BigInt> operator/(const std::string& num) const;
 
-    void operator/=(const BigInt& num);
-    void operator/=(const std::string& num);
+    BigInt& operator/=(const BigInt& num);
+    BigInt& operator/=(const std::string& num);
 
     BigInt operator%(const BigInt& base) const;
     BigInt operator%(const std::string& base) const;
 
 
-    void operator%=(const BigInt& num);
+    BigInt& operator%=(const BigInt& num);
 
     static BigInt max(const BigInt& a, const BigInt& b);
     static BigInt modularAddition(const BigInt& a, const BigInt& b, const BigInt& m);
@@ -95,6 +113,10 @@ public:
     static BigInt inverseModulo(const BigInt& a, const BigInt& m);
     // Computes (base ^ exponent) % modulus using modular exponentiation
     static BigInt modularPower(const BigInt& base, const BigInt& exponent, const BigInt& modulus);
+    // Computes (b1 ^ e1 * b2 ^ e2 * ...) % modulus with one shared chain of squarings
+    static BigInt multiExp(const std::vector<BigInt>& bases, const std::vector<BigInt>& exponents, const BigInt& modulus);
+    // Jacobi symbol (a / n) for odd n > 0: 1, -1, or 0 when gcd(a, n) > 1
+    static int jacobi(const BigInt& a, const BigInt& n);
 
 
     friend std::istream& operator>>(std::istream& in, BigInt& num);
@@ -116,96 +138,67 @@ private:
 };
 
 /**
- * @brief Convert a char to int.
- *
- * @param c char
- * @return int
- */
-
-
-int BigInt::_charIntToInt(char c) const {
-    return c - '0';
-}
-
-/**
- * @brief Convert an int to char.
- *
- * @param num int
- * @return char
+ * @brief Remove leading zero limbs, zero is never negative.
  */
-char BigInt::_intToChar(int num) const {
-    return num + '0';
+void BigInt::_trim() {
+    while (!_limbs.empty() && _limbs.back() == 0) {
+        _limbs.pop_back();
+    }
+    if (_limbs.empty()) {
+        _negative = false;
+    }
 }
 
-/**
- * @brief Reverse a string.
- *
- * @param str const std::string&
- * @return std::string
- */
-std::string BigInt::_reverse(const std::string& str) const {
-    return std::string(str.rbegin(), str.rend());
+bool BigInt::_isZero() const {
+    return _limbs.empty();
 }
 
 /**
- * @brief Remove leading zeros (00123 => 123)
+ * @brief Load a string of decimal digits (leading zeros allowed), 9 digits per limb.
  *
- * @param  num const std::string&
- * @return std::string
+ * @param digits const std::string&
  */
-std::string BigInt::_removeLeadingZeros(const std::string& num) const {
-    std::stringstream ss;
-    bool valid = false;
-
-    for (int i = 0; i < (int)num.length(); ++i) {
-        if (num[i] == '0' && !valid) {
-            continue;
-        }
-        else {
-            valid = true;
-            ss << num[i];
+void BigInt::_parseDigits(const std::string& digits) {
+    _limbs.clear();
+    _limbs.reserve(digits.length() / BASE_DIGITS + 1);
+
+    // Cắt từ phải sang trái, mỗi đoạn 9 chữ số
+    for (int end = (int)digits.length(); end > 0; end -= BASE_DIGITS) {
+        int begin = std::max(0, end - BASE_DIGITS);
+        uint32_t limb = 0;
+        for (int i = begin; i < end; ++i) {
+            limb = limb * 10 + (digits[i] - '0');
         }
+        _limbs.push_back(limb);
     }
 
-    if (ss.str().length() == 0) {
-        ss << 0;
-    }
-
-    return ss.str();
+    _trim();
 }
 
 /**
- * @brief Add leading zeros (123, zeros = 4 => 0000123)
+ * @brief Decimal digits of the absolute value (123 => "123", 0 => "0").
  *
- * @param num std::string&
- * @param totalZeros int
+ * @return std::string
  */
-void BigInt::_addLeadingZeros(std::string& num, int totalZeros) const {
-    std::stringstream ss;
-
-    for (int i = 1; i <= totalZeros; ++i) {
-        ss << 0;
+std::string BigInt::_toString() const {
+    if (_isZero()) {
+        return "0";
     }
-    ss << num;
 
-    num = ss.str();
-}
+    std::string str = std::to_string(_limbs.back());
+    str.reserve(str.length() + (_limbs.size() - 1) * BASE_DIGITS);
 
-/**
- * @brief Add trailing zeros (123, zeros = 4 => 1230000)
- *
- * @param num std::string&
- * @param totalZeros int
- */
-void BigInt::_addTrailingZeros(std::string& num, int totalZeros) const {
-    std::stringstream ss;
-
-    ss << num;
-    for (int i = 1; i <= totalZeros; ++i) {
-        ss << 0;
+    char buf[BASE_DIGITS];
+    for (int i = (int)_limbs.size() - 2; i >= 0; --i) {
+        uint32_t limb = _limbs[i];
+        for (int k = BASE_DIGITS - 1; k >= 0; --k) {
+            buf[k] = '0' + limb % 10;
+            limb /= 10;
+        }
+        str.append(buf, BASE_DIGITS);
     }
 
-    num = ss.str();
+    return str;
 }
 
 /**
@@ -245,10 +238,230 @@ std::string BigInt::_absolute(const std::string& num) {
     return num.substr(1, num.length() - 1);
 }
 
+/**
+ * @brief Compare |a| and |b|.
+ *
+ * @return int -1, 0 or 1
+ */
+int BigInt::_compareAbs(const BigInt& a, const BigInt& b) {
+    return _compareLimbs(a._limbs, b._limbs);
+}
+
+int BigInt::_compareLimbs(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    if (a.size() != b.size()) {
+        return (a.size() < b.size()) ? -1 : 1;
+    }
+
+    for (int i = (int)a.size() - 1; i >= 0; --i) {
+        if (a[i] != b[i]) {
+            return (a[i] < b[i]) ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief x += y in place (x and y may be the same vector)
+ */
+void BigInt::_addAbsInPlace(std::vector<uint32_t>& x, const std::vector<uint32_t>& y) {
+    if (x.size() < y.size()) {
+        x.resize(y.size(), 0);
+    }
+
+    uint32_t carry = 0;
+    size_t i = 0;
+    for (; i < y.size(); ++i) {
+        uint32_t sum = x[i] + y[i] + carry;
+        carry = sum >= BASE;
+        x[i] = carry ? sum - BASE : sum;
+    }
+    for (; carry && i < x.size(); ++i) {
+        uint32_t sum = x[i] + carry;
+        carry = sum >= BASE;
+        x[i] = carry ? sum - BASE : sum;
+    }
+    if (carry) {
+        x.push_back(carry);
+    }
+}
+
+/**
+ * @brief x = x - y (requires x >= y), or x = y - x when reverse is set (requires y >= x).
+ * Works in place, x and y may be the same vector.
+ */
+void BigInt::_subAbsInPlace(std::vector<uint32_t>& x, const std::vector<uint32_t>& y, bool reverse) {
+    if (x.size() < y.size()) {
+        x.resize(y.size(), 0);
+    }
+
+    int64_t borrow = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        int64_t yi = (i < y.size()) ? y[i] : 0;
+        if (!reverse && i >= y.size() && !borrow) break;
+
+        int64_t diff = reverse ? yi - x[i] - borrow : x[i] - yi - borrow;
+        borrow = diff < 0;
+        x[i] = (uint32_t)(borrow ? diff + BASE : diff);
+    }
+
+    while (!x.empty() && x.back() == 0) {
+        x.pop_back();
+    }
+}
+
+/**
+ * @brief out = |a| * |b|, schoolbook on 10^9 limbs with 64-bit accumulators.
+ * out must not be a or b, its capacity is reused.
+ */
+void BigInt::_mulAbsInto(std::vector<uint32_t>& out, const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    out.clear();
+    if (a.empty() || b.empty()) {
+        return;
+    }
+
+    out.resize(a.size() + b.size(), 0);
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < b.size(); ++j) {
+            uint64_t cur = out[i + j] + (uint64_t)a[i] * b[j] + carry;
+            out[i + j] = (uint32_t)(cur % BASE);
+            carry = cur / BASE;
+        }
+        out[i + b.size()] = (uint32_t)carry;
+    }
+
+    while (!out.empty() && out.back() == 0) {
+        out.pop_back();
+    }
+}
+
+/**
+ * @brief x *= m in place, m < 10^9
+ */
+void BigInt::_mulSmall(std::vector<uint32_t>& x, uint32_t m) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        uint64_t cur = (uint64_t)x[i] * m + carry;
+        x[i] = (uint32_t)(cur % BASE);
+        carry = cur / BASE;
+    }
+    if (carry > 0) {
+        x.push_back((uint32_t)carry);
+    }
+}
+
+/**
+ * @brief x /= d in place, d < 10^9
+ *
+ * @return uint32_t remainder
+ */
+uint32_t BigInt::_divSmall(std::vector<uint32_t>& x, uint32_t d) {
+    uint64_t rem = 0;
+    for (int i = (int)x.size() - 1; i >= 0; --i) {
+        uint64_t cur = rem * BASE + x[i];
+        x[i] = (uint32_t)(cur / d);
+        rem = cur % d;
+    }
+    while (!x.empty() && x.back() == 0) {
+        x.pop_back();
+    }
+    return (uint32_t)rem;
+}
+
+/**
+ * @brief a = q * b + r with 0 <= r < b (Knuth 4.3.1 Algorithm D in base 10^9).
+ * q may be null when only the remainder is needed. r may be the same vector as a or b,
+ * the working copies live in per-thread buffers so repeated calls do not allocate.
+ */
+void BigInt::_divModLimbs(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b,
+    std::vector<uint32_t>* q, std::vector<uint32_t>& r) {
+    static thread_local std::vector<uint32_t> u, v;
+
+    if (_compareLimbs(a, b) < 0) {
+        r = a;
+        if (q) q->clear();
+        return;
+    }
+
+    if (b.size() == 1) {
+        const uint32_t d = b[0];
+        u = a;
+        uint32_t rem = _divSmall(u, d);
+        if (q) q->swap(u);
+        r.clear();
+        if (rem > 0) {
+            r.push_back(rem);
+        }
+        return;
+    }
+
+    // Chuẩn hóa để limb cao nhất của số chia >= BASE / 2
+    const uint32_t norm = BASE / (b.back() + 1);
+    const int n = (int)b.size();
+    const int m = (int)a.size() - n;
+    u = a;
+    v = b;
+    _mulSmall(u, norm);
+    _mulSmall(v, norm);
+    u.resize(a.size() + 1, 0);
+
+    if (q) q->assign(m + 1, 0);
+
+    for (int j = m; j >= 0; --j) {
+        uint64_t num = (uint64_t)u[j + n] * BASE + u[j + n - 1];
+        uint64_t qhat = num / v[n - 1];
+        uint64_t rhat = num % v[n - 1];
+
+        while (qhat >= BASE || qhat * v[n - 2] > rhat * BASE + u[j + n - 2]) {
+            --qhat;
+            rhat += v[n - 1];
+            if (rhat >= BASE) break;
+        }
+
+        // u[j .. j + n] -= qhat * v
+        uint64_t carry = 0;
+        int64_t borrow = 0;
+        for (int i = 0; i < n; ++i) {
+            uint64_t prod = qhat * v[i] + carry;
+            carry = prod / BASE;
+            int64_t diff = (int64_t)u[i + j] - (int64_t)(prod % BASE) - borrow;
+            borrow = diff < 0;
+            u[i + j] = (uint32_t)(borrow ? diff + BASE : diff);
+        }
+        int64_t top = (int64_t)u[j + n] - (int64_t)carry - borrow;
+
+        if (top < 0) {
+            // qhat lớn hơn 1, cộng lại v
+            --qhat;
+            uint32_t c = 0;
+            for (int i = 0; i < n; ++i) {
+                uint32_t sum = u[i + j] + v[i] + c;
+                c = sum >= BASE;
+                u[i + j] = c ? sum - BASE : sum;
+            }
+            top += c;
+        }
+        u[j + n] = (uint32_t)top;
+
+        if (q) (*q)[j] = (uint32_t)qhat;
+    }
+
+    if (q) {
+        while (!q->empty() && q->back() == 0) {
+            q->pop_back();
+        }
+    }
+
+    u.resize(n);
+    _divSmall(u, norm);
+    r = u;
+}
+
 BigInt::BigInt() {
     // Do nothing
     _negative = false;
-    _num = "0";
 }
 
 BigInt::BigInt(const std::string& num) {
@@ -258,31 +471,46 @@ BigInt::BigInt(const std::string& num) {
 
     _negative = _isNegative(num);
 
-    _num = (_negative) ? _removeLeadingZeros(_absolute(num)) : _removeLeadingZeros(num);
+    _parseDigits(_negative ? _absolute(num) : num);
 }
 
 BigInt::BigInt(const std::string& num, bool negative) {
-    _num = _removeLeadingZeros(num);
     _negative = negative;
+    _parseDigits(num);
 }
 
 BigInt::BigInt(const BigInt& num) {
-    _num = num._num;
+    _limbs = num._limbs;
     _negative = num._negative;
 }
 
+BigInt::BigInt(BigInt&& num) noexcept {
+    _limbs = std::move(num._limbs);
+    _negative = num._negative;
+    num._negative = false;
+}
+
 /**
  * @brief Set the number's sign (negative or not)
  *
  * @param negativity bool | true = negative, false = positive.
  */
 void BigInt::setNegative(bool negativity) {
-    _negative = negativity;
+    _negative = negativity && !_isZero();
 }
 
-void BigInt::operator=(const BigInt& num) {
-    _num = num._num;
+BigInt& BigInt::operator=(const BigInt& num) {
+    // vector::operator= tái sử dụng bộ nhớ đã cấp phát nếu đủ chỗ
+    _limbs = num._limbs;
     _negative = num._negative;
+    return *this;
+}
+
+BigInt& BigInt::operator=(BigInt&& num) noexcept {
+    _limbs = std::move(num._limbs);
+    _negative = num._negative;
+    num._negative = false;
+    return *this;
 }
 
 BigInt::~BigInt() {
@@ -293,11 +521,30 @@ bool BigInt::isNegative() const {
     return _negative;
 }
 
-char& BigInt::operator[](const int index) {
-    if (index < 0 || index >(int)_num.length()) {
+/**
+ * @brief Decimal digit at index, counted from the most significant digit.
+ *
+ * @param index const int
+ * @return char '0'..'9'
+ */
+char BigInt::operator[](const int index) const {
+    int topDigits = 1;
+    if (!_isZero()) {
+        for (uint32_t t = _limbs.back(); t >= 10; t /= 10) ++topDigits;
+    }
+    const int length = topDigits + (_isZero() ? 0 : ((int)_limbs.size() - 1) * BASE_DIGITS);
+
+    if (index < 0 || index >= length) {
         throw std::runtime_error("Index out of bound");
     }
-    return _num[index];
+    if (_isZero()) {
+        return '0';
+    }
+
+    const int pos = length - 1 - index;
+    uint32_t limb = _limbs[pos / BASE_DIGITS];
+    for (int k = 0; k < pos % BASE_DIGITS; ++k) limb /= 10;
+    return '0' + limb % 10;
 }
 
 bool BigInt::operator<(const BigInt& num) const {
@@ -306,13 +553,9 @@ bool BigInt::operator<(const BigInt& num) const {
         return isNegative();
     }
 
-    // 2 số có độ dài khác nhau => tùy vào dấu mà đưa ra số nhỏ hơn.
-    if (_num.length() != num._num.length()) {
-        return (isNegative()) ? (_num.length() > num._num.length())
-            : (_num.length() < num._num.length());
-    }
-
-    return isNegative() ? (_num > num._num) : (_num < num._num);
+    // Cùng dấu => so sánh trị tuyệt đối, đảo chiều nếu là số âm
+    int cmp = _compareAbs(*this, num);
+    return isNegative() ? (cmp > 0) : (cmp < 0);
 }
 
 bool BigInt::operator<(const std::string& num) const {
@@ -320,7 +563,7 @@ bool BigInt::operator<(const std::string& num) const {
 }
 
 bool BigInt::operator>(const BigInt& num) const {
-    return !(*this <= num);
+    return num < *this;
 }
 
 bool BigInt::operator>(const std::string& num) const {
@@ -328,7 +571,7 @@ bool BigInt::operator>(const std::string& num) const {
 }
 
 bool BigInt::operator==(const BigInt& num) const {
-    return (_num == num._num) && (_negative == num._negative);
+    return (_negative == num._negative) && (_limbs == num._limbs);
 }
 
 bool BigInt::operator==(const std::string& num) const {
@@ -344,7 +587,7 @@ bool BigInt::operator!=(const std::string& num) const {
 }
 
 bool BigInt::operator<=(const BigInt& num) const {
-    return (*this == num || *this < num);
+    return !(num < *this);
 }
 
 bool BigInt::operator<=(const std::string& num) const {
@@ -352,174 +595,85 @@ bool BigInt::operator<=(const std::string& num) const {
 }
 
 bool BigInt::operator>=(const BigInt& num) const {
-    return (*this == num || *this > num);
+    return !(*this < num);
 }
 
 bool BigInt::operator>=(const std::string& num) const {
-    return *this >= num;
+    return *this >= BigInt(num);
 }
 
 BigInt BigInt::operator+(const BigInt& num) const {
-    // Xét dấu phép cộng. Đơn giản là khác dấu => chuyển sang phép trừ, cùng dấu => mang dấu chung.
-    if (isNegative() != num.isNegative()) {
-        return isNegative() ? num - BigInt(_num, !isNegative()) : *this - BigInt(num._num, !num.isNegative());
-    }
+    BigInt result(*this);
+    result += num;
+    return result;
+}
 
-    std::stringstream ss;
+BigInt BigInt::operator+(const std::string& num) const {
+    return *this + BigInt(num);
+}
 
-    std::string firstNum = _num;
-    std::string secondNum = num._num;
+BigInt& BigInt::operator+=(const BigInt& num) {
+    const bool numNegative = num.isNegative();
 
-    // Thêm số 0 vào trước để 2 string bằng nhau => tránh index out of bound.
-    if ((int)_num.length() > (int)secondNum.length()) {
-        _addLeadingZeros(secondNum, (int)(firstNum.length() - secondNum.length()));
-    }
-    else if ((int)_num.length() < (int)secondNum.length()) {
-        _addLeadingZeros(firstNum, (int)(secondNum.length() - firstNum.length()));
+    // Cùng dấu => cộng trị tuyệt đối, giữ nguyên dấu.
+    if (isNegative() == numNegative) {
+        _addAbsInPlace(_limbs, num._limbs);
+        return *this;
     }
 
-    // Cộng như hồi tiểu học (từ phải sang trái)
-    int carry = 0;
-    for (int i = (int)firstNum.length() - 1; i >= 0; --i) {
-        int currentSum = _charIntToInt(firstNum[i]) + _charIntToInt(secondNum[i]) + carry;
-
-        ss << currentSum % 10;
-        carry = currentSum / 10;
+    // Khác dấu => lấy trị tuyệt đối lớn hơn trừ số còn lại, mang dấu của số lớn hơn.
+    if (_compareAbs(*this, num) >= 0) {
+        _subAbsInPlace(_limbs, num._limbs, false);
     }
-
-    if (carry > 0) {
-        while (carry > 0) {
-            ss << carry % 10;
-            carry /= 10;
-        }
+    else {
+        _subAbsInPlace(_limbs, num._limbs, true);
+        _negative = numNegative;
     }
-
-    return BigInt(_reverse(ss.str()), isNegative());
+    _trim();
+    return *this;
 }
 
-BigInt BigInt::operator+(const std::string& num) const {
-    return *this + BigInt(num);
+BigInt& BigInt::operator+=(const std::string& num) {
+    return *this += BigInt(num);
 }
 
-void BigInt::operator+=(const BigInt& num) {
-    // Goes brrr
-    *this = *this + num;
+BigInt BigInt::operator-(const BigInt& num) const {
+    BigInt result(*this);
+    result -= num;
+    return result;
 }
 
-void BigInt::operator+=(const std::string& num) {
-    *this += BigInt(num);
+BigInt BigInt::operator-(const std::string& num) const {
+    return *this - BigInt(num);
 }
 
-BigInt BigInt::operator-(const BigInt& num) const {
-    // Xét dấu phép trừ:
-    // a > 0, b < 0 aka a - (-b): trả về a + b
-    // a < 0, b > 0 aka -a - b: trả về -(a + b)
-    if (isNegative() != num.isNegative()) {
-        BigInt result = BigInt(_num) + BigInt(num._num);
-        result.setNegative(isNegative());
-        return result;
-    }
-
-    // Nếu cả 2 số đều âm thì lấy num - *this. Hay là, (-a) - (-b) = b - a.
-    if (isNegative() && num.isNegative()) {
-        return BigInt(num._num) - BigInt(_num);
-    }
+BigInt& BigInt::operator-=(const BigInt& num) {
+    // a - b = a + (-b), chỉ khác ở dấu của b
+    const bool numNegative = !num.isNegative() && !num._isZero();
 
-    // Các trường hợp trừ 0 và 0 trừ.
-    if (num == "0") {
+    if (isNegative() == numNegative) {
+        _addAbsInPlace(_limbs, num._limbs);
         return *this;
     }
 
-    if (_num == "0" && num != "0") {
-        BigInt result = num;
-        result.setNegative(!num.isNegative());
-        return result;
+    if (_compareAbs(*this, num) >= 0) {
+        _subAbsInPlace(_limbs, num._limbs, false);
     }
-
-    // Trường hợp còn lại - 2 số nguyên dương trừ nhau.
-    std::stringstream ss;
-
-    std::string firstNum = _num;
-    std::string secondNum = num._num;
-
-    // Thêm số 0 vào trước để 2 string bằng nhau => tránh index out of bound.
-    if ((int)_num.length() > (int)secondNum.length()) {
-        _addLeadingZeros(secondNum, (int)(firstNum.length() - secondNum.length()));
-    }
-    else if ((int)_num.length() < (int)secondNum.length()) {
-        _addLeadingZeros(firstNum, (int)(secondNum.length() - firstNum.length()));
-    }
-
-    // Swap order if firstNum < secondNum
-    if (*this < num) {
-        std::swap(firstNum, secondNum);
-    }
-
-    // Reverse both of strings
-    firstNum = _reverse(firstNum);
-    secondNum = _reverse(secondNum);
-
-    int carry = 0;
-
-    for (int i = 0; i < (int)firstNum.length(); i++) {
-        int sub = _charIntToInt(firstNum[i]) - _charIntToInt(secondNum[i]) - carry;
-        if (sub < 0) {
-            sub += 10;
-            carry = 1;
-        }
-        else {
-            carry = 0;
-        }
-        ss << sub;
+    else {
+        _subAbsInPlace(_limbs, num._limbs, true);
+        _negative = numNegative;
     }
-
-    return BigInt(_reverse(ss.str()), (*this < num));
-}
-
-BigInt BigInt::operator-(const std::string& num) const {
-    return *this - BigInt(num);
-}
-
-void BigInt::operator-=(const BigInt& num) {
-    *this = *this - num;
+    _trim();
+    return *this;
 }
 
-void BigInt::operator-=(const std::string& num) {
-    *this -= BigInt(num);
+BigInt& BigInt::operator-=(const std::string& num) {
+    return *this -= BigInt(num);
 }
 
 BigInt BigInt::operator*(const BigInt& num) const {
-    std::stringstream ss;
-
-    std::string firstNum = _num;
-    std::string secondNum = num._num;
-
-    if (firstNum == "0" || secondNum == "0") {
-        return BigInt("0");
-    }
-
     BigInt result;
-
-    int carry = 0;
-    for (int i = (int)secondNum.length() - 1; i >= 0; --i) {
-        if (secondNum[i] == '0') continue;
-        for (int j = (int)firstNum.length() - 1; j >= 0; --j) {
-            int current_prod = _charIntToInt(firstNum[j]) * _charIntToInt(secondNum[i]) + carry;
-
-            ss << current_prod % 10;
-            carry = current_prod / 10;
-        }
-
-        while (carry > 0) {
-            ss << carry % 10;
-            carry /= 10;
-        }
-
-        std::string lineResult = _reverse(ss.str());
-        _addTrailingZeros(lineResult, secondNum.length() - i - 1);
-
-        result += BigInt(lineResult); ss.str("");
-    }
+    _mulAbsInto(result._limbs, _limbs, num._limbs);
 
     // Result sign
     result.setNegative(isNegative() != num.isNegative());
@@ -531,89 +685,83 @@ BigInt BigInt::operator*(const std::string& num) const {
     return *this * BigInt(num);
 }
 
-void BigInt::operator*=(const BigInt& num) {
-    // Goes brrr
-    *this = *this * num;
+BigInt& BigInt::operator*=(const BigInt& num) {
+    // Nhân vào bộ đệm tạm rồi đổi chỗ, bộ nhớ cũ của *this trở thành bộ đệm cho lần sau
+    static thread_local std::vector<uint32_t> product;
+
+    _mulAbsInto(product, _limbs, num._limbs);
+    _limbs.swap(product);
+    setNegative(isNegative() != num.isNegative());
+    return *this;
 }
 
-void BigInt::operator*=(const std::string& num) {
-    *this *= BigInt(num);
+BigInt& BigInt::operator*=(const std::string& num) {
+    return *this *= BigInt(num);
 }
 
 /**
- * @note Thuật tham khảo từ Tài liệu giáo khoa chuyên tin, quyển 1
- *
- * (c) thầy Hồ Sĩ Đàm, Đỗ Đức Đông, Lê Minh Hoàng, Nguyễn Thanh Hùng.
+ * @brief Division of the absolute values.
  *
  * @param  num const BigInt&
  * @return std::tuple<quotient, remainder>
  */
 std::tuple<BigInt, BigInt> BigInt::operator/(const BigInt& num) const {
-    BigInt zero("0");
-
-    if (num == zero) {
+    if (num._isZero()) {
         throw std::runtime_error("Zero divison");
     }
 
-    std::vector<BigInt> kb(11, zero);
-
-    for (int i = 1; i <= 10; ++i) {
-        kb[i] = kb[i - 1] + num;
-    }
-
-    BigInt c(zero);
-    std::string hold = "";
-
-    for (int i = 0; i < (int)_num.length(); ++i) {
-        hold = hold + _num[i];
-
-        int k = 0;
-        for (; kb[k] <= hold; ++k);
-
-        c._num += _intToChar(k - 1);
-
-        hold = (BigInt(hold) - kb[k - 1])._num;
-    }
+    BigInt q, r;
+    _divModLimbs(_limbs, num._limbs, &q._limbs, r._limbs);
 
-    c._num = _removeLeadingZeros(c._num);
-
-    return std::make_tuple(BigInt(c), BigInt(hold));
+    return std::make_tuple(std::move(q), std::move(r));
 }
 
 std::tuple<BigInt, BigInt> BigInt::operator/(const std::string& num) const {
     return *this / BigInt(num);
 }
 
-void BigInt::operator/=(const BigInt& num) {
-    *this = std::get<0>(*this / num);
+BigInt& BigInt::operator/=(const BigInt& num) {
+    if (num._isZero()) {
+        throw std::runtime_error("Zero divison");
+    }
+
+    static thread_local std::vector<uint32_t> rem;
+
+    _divModLimbs(_limbs, num._limbs, &_limbs, rem);
+    _negative = false;
+    return *this;
 }
 
-void BigInt::operator/=(const std::string& num) {
-    *this /= BigInt(num);
+BigInt& BigInt::operator/=(const std::string& num) {
+    return *this /= BigInt(num);
 }
 
-/**
- * @note Thuật tham khảo từ Tài liệu giáo khoa chuyên tin, quyển 1
- *
- * (c) thầy Hồ Sĩ Đàm, Đỗ Đức Đông, Lê Minh Hoàng, Nguyễn Thanh Hùng.
- */
 BigInt BigInt::operator%(const BigInt& base) const {
-    auto result = *this / base;
-
-    if (*this < "0") {
-        return base - std::get<1>(result);
-    }
-
-    return std::get<1>(*this / base);
+    BigInt result(*this);
+    result %= base;
+    return result;
 }
 
 BigInt BigInt::operator%(const std::string& base) const {
     return *this % BigInt(base);
 }
 
-void BigInt::operator%=(const BigInt& num) {
-    // Goes brrr
-    *this = *this % num;
+BigInt& BigInt::operator%=(const BigInt& num) {
+    if (num._isZero()) {
+        throw std::runtime_error("Zero divison");
+    }
+
+    const bool negative = isNegative();
+
+    _divModLimbs(_limbs, num._limbs, nullptr, _limbs);
+    _negative = false;
+
+    // Số âm: kết quả là num - (|a| mod num), tính bằng -(r - num)
+    if (negative && !_isZero()) {
+        *this -= num;
+        setNegative(!isNegative());
+    }
+    return *this;
 }
 
 /**
@@ -636,15 +784,15 @@ BigInt BigInt::max(const BigInt& a, const BigInt& b) {
  * @return BigInt
  */
 BigInt BigInt::modularAddition(const BigInt& a, const BigInt& b, const BigInt& m) {
-    BigInt zero("0");
-
-    if (m <= zero) {
+    if (m.isNegative() || m._isZero()) {
         throw std::runtime_error("Invalid modular base");
     }
 
-    BigInt first = (a >= zero) ? a : (m - a);
-    BigInt second = (b >= zero) ? b : (m - b);
-    return ((first % m) + (second % m)) % m;
+    BigInt result = a.isNegative() ? m - a : a;
+    result %= m;
+    result += b.isNegative() ? m - b : b;
+    result %= m;
+    return result;
 }
 
 /**
@@ -656,15 +804,22 @@ BigInt BigInt::modularAddition(const BigInt& a, const BigInt& b, const BigInt& m
  * @return BigInt
  */
 BigInt BigInt::modularMultiplication(const BigInt& a, const BigInt& b, const BigInt& m) {
-    BigInt zero("0");
-
-    if (m <= zero) {
+    if (m.isNegative() || m._isZero()) {
         throw std::runtime_error("Invalid modular base");
     }
 
-    BigInt first = (a >= zero) ? a : m - a;
-    BigInt second = (b >= zero) ? b : m - b;
-    return ((first % m) * (second % m)) % m;
+    BigInt result = a.isNegative() ? m - a : a;
+    result %= m;
+
+    // b đã nằm trong [0, m) thì nhân thẳng, không cần bản sao
+    if (!b.isNegative() && _compareAbs(b, m) < 0) {
+        result *= b;
+    }
+    else {
+        result *= (b.isNegative() ? m - b : b) % m;
+    }
+    result %= m;
+    return result;
 }
 
 /**
@@ -692,6 +847,232 @@ BigInt BigInt::inverseModulo(const BigInt& a, const BigInt& m) {
     return std::get<1>(res) % m;
 }
 
+/**
+ * @brief Barrett reduction in base 10^9: x = x mod m for 0 <= x < m^2.
+ * mu = floor(BASE^(2k) / m) with k = m.size(), computed once per modulus (HAC 14.42).
+ *
+ * @param x std::vector<uint32_t>&
+ * @param m const std::vector<uint32_t>&
+ * @param mu const std::vector<uint32_t>&
+ */
+void BigInt::_barrettReduce(std::vector<uint32_t>& x, const std::vector<uint32_t>& m, const std::vector<uint32_t>& mu) {
+    static thread_local std::vector<uint32_t> q1, q2, r2;
+    const size_t k = m.size();
+
+    if (_compareLimbs(x, m) < 0) {
+        return;
+    }
+
+    // q3 = floor(floor(x / BASE^(k-1)) * mu / BASE^(k+1)), lệch thương đúng nhiều nhất 2
+    q1.assign(x.begin() + (k - 1), x.end());
+    _mulAbsInto(q2, q1, mu);
+    if (q2.size() > k + 1) {
+        q1.assign(q2.begin() + (k + 1), q2.end());
+    }
+    else {
+        q1.clear();
+    }
+
+    // x = (x mod BASE^(k+1)) - (q3 * m mod BASE^(k+1))
+    _mulAbsInto(r2, q1, m);
+    if (r2.size() > k + 1) r2.resize(k + 1);
+    while (!r2.empty() && r2.back() == 0) r2.pop_back();
+    if (x.size() > k + 1) x.resize(k + 1);
+    while (!x.empty() && x.back() == 0) x.pop_back();
+
+    if (_compareLimbs(x, r2) < 0) {
+        x.resize(k + 2, 0);
+        x[k + 1] = 1;
+    }
+    _subAbsInPlace(x, r2, false);
+
+    while (_compareLimbs(x, m) >= 0) {
+        _subAbsInPlace(x, m, false);
+    }
+}
+
+/**
+ * @brief Computes (base ^ exponent) % modulus.
+ *
+ * @param base const BigInt&
+ * @param exponent const BigInt&
+ * @param modulus const BigInt&
+ * @return BigInt
+ */
+BigInt BigInt::modularPower(const BigInt& base, const BigInt& exponent, const BigInt& modulus) {
+    return multiExp({ base }, { exponent }, modulus);
+}
+
+/**
+ * @brief Computes (b1 ^ e1 * b2 ^ e2 * ...) % modulus in one pass (Straus / Shamir's trick).
+ *
+ * Every exponent is converted to binary once and cut into sliding windows over a
+ * table of odd powers of its base. The bases share a single chain of squarings,
+ * so y^r * r^h costs about as many squarings as one exponentiation. Every product
+ * is reduced with Barrett.
+ *
+ * @param bases const std::vector<BigInt>&
+ * @param exponents const std::vector<BigInt>&
+ * @param modulus const BigInt&
+ * @return BigInt
+ */
+BigInt BigInt::multiExp(const std::vector<BigInt>& bases, const std::vector<BigInt>& exponents, const BigInt& modulus) {
+    if (modulus.isNegative() || modulus._isZero()) {
+        throw std::runtime_error("Invalid modular base");
+    }
+    if (bases.size() != exponents.size()) {
+        throw std::runtime_error("Bases and exponents do not match");
+    }
+
+    if (modulus._limbs.size() == 1 && modulus._limbs[0] == 1) {
+        return BigInt();
+    }
+
+    // mu = floor(BASE^(2k) / m)
+    const std::vector<uint32_t>& m = modulus._limbs;
+    std::vector<uint32_t> mu(2 * m.size() + 1, 0), rem;
+    mu.back() = 1;
+    _divModLimbs(mu, m, &mu, rem);
+
+    std::vector<uint32_t> product;
+    auto mulMod = [&](std::vector<uint32_t>& x, const std::vector<uint32_t>& y) {
+        _mulAbsInto(product, x, y);
+        _barrettReduce(product, m, mu);
+        x.swap(product);
+    };
+
+    const size_t count = bases.size();
+    std::vector<std::vector<std::vector<uint32_t>>> tables(count);
+    std::vector<std::vector<int>> windowAt(count); // windowAt[j][i] = chỉ số trong bảng nếu cửa sổ kết thúc ở bit i
+    int maxBits = 0;
+
+    for (size_t j = 0; j < count; ++j) {
+        BigInt base = bases[j] % modulus;
+        BigInt exponent = exponents[j];
+
+        // Số mũ âm: a^(-e) = (a^-1)^e
+        if (exponent.isNegative()) {
+            base = inverseModulo(base, modulus);
+            exponent.setNegative(false);
+        }
+
+        // Đổi số mũ sang nhị phân một lần, mỗi lần chia lấy 31 bit
+        std::vector<char> bits;
+        while (!exponent._isZero()) {
+            uint32_t chunk = _divSmall(exponent._limbs, 1u << 31);
+            for (int i = 0; i < 31; ++i) {
+                bits.push_back((chunk >> i) & 1);
+            }
+        }
+        while (!bits.empty() && !bits.back()) {
+            bits.pop_back();
+        }
+
+        const int nbits = (int)bits.size();
+        const int window = nbits > 671 ? 6 : nbits > 239 ? 5 : nbits > 79 ? 4 : nbits > 23 ? 3 : 1;
+        maxBits = std::max(maxBits, nbits);
+
+        // Cửa sổ dài nhất (tối đa window bit) bắt đầu từ bit 1 cao nhất và kết thúc bằng bit 1
+        windowAt[j].assign(nbits, -1);
+        int largest = 0;
+        for (int i = nbits - 1; i >= 0;) {
+            if (!bits[i]) {
+                --i;
+                continue;
+            }
+
+            int low = std::max(i - window + 1, 0);
+            while (!bits[low]) ++low;
+
+            int value = 0;
+            for (int k = i; k >= low; --k) {
+                value = value << 1 | bits[k];
+            }
+            windowAt[j][low] = value >> 1;
+            largest = std::max(largest, value >> 1);
+            i = low - 1;
+        }
+
+        // tables[j][i] = base^(2i + 1) mod m, chỉ tới lũy thừa lẻ lớn nhất thực sự dùng
+        if (nbits == 0) continue;
+        tables[j].resize(largest + 1);
+        tables[j][0] = base._limbs;
+        if (largest > 0) {
+            std::vector<uint32_t> square = tables[j][0];
+            mulMod(square, tables[j][0]);
+            for (int i = 1; i <= largest; ++i) {
+                tables[j][i] = tables[j][i - 1];
+                mulMod(tables[j][i], square);
+            }
+        }
+    }
+
+    BigInt result("1");
+    std::vector<uint32_t>& acc = result._limbs;
+    bool started = false;
+
+    for (int i = maxBits - 1; i >= 0; --i) {
+        if (started) {
+            mulMod(acc, acc);
+        }
+
+        for (size_t j = 0; j < count; ++j) {
+            if (i < (int)windowAt[j].size() && windowAt[j][i] >= 0) {
+                if (started) {
+                    mulMod(acc, tables[j][windowAt[j][i]]);
+                }
+                else {
+                    acc = tables[j][windowAt[j][i]];
+                    started = true;
+                }
+            }
+        }
+    }
+
+    result._trim();
+    return result;
+}
+
+/**
+ * @brief Jacobi symbol (a / n) by the binary reciprocity algorithm, no exponentiation.
+ *
+ * For a prime n it is the Legendre symbol: 1 if a is a nonzero square mod n, -1 if not.
+ * BASE = 10^9 is a multiple of 2^9, so parity and residues mod 8 come from the low limb.
+ *
+ * @param a const BigInt&
+ * @param n const BigInt& odd, positive
+ * @return int 1, -1 or 0
+ */
+int BigInt::jacobi(const BigInt& a, const BigInt& n) {
+    BigInt x = a % n;
+    BigInt y = n;
+    int result = 1;
+
+    while (!x._isZero()) {
+        // Bỏ các thừa số 2, tối đa 9 bit mỗi lần; (2 / y) = -1 khi y = 3, 5 (mod 8)
+        int twos = 0;
+        while (!(x._limbs[0] & 1)) {
+            int k = 0;
+            while (k < 9 && !((x._limbs[0] >> k) & 1)) ++k;
+            _divSmall(x._limbs, 1u << k);
+            twos += k;
+        }
+        const uint32_t y8 = y._limbs[0] % 8;
+        if ((twos & 1) && (y8 == 3 || y8 == 5)) {
+            result = -result;
+        }
+
+        // Luật thuận nghịch bậc hai: đổi dấu khi cả x và y đều = 3 (mod 4)
+        if (x._limbs[0] % 4 == 3 && y8 % 4 == 3) {
+            result = -result;
+        }
+        std::swap(x, y);
+        x %= y;
+    }
+
+    return y == "1" ? result : 0;
+}
+
 
 /**
  * @brief Tìm Bezout Identity (aka tìm x, y sao cho ax + by = (a, b))
@@ -737,7 +1118,7 @@ std::ostream& operator<<(std::ostream& out, const BigInt& num) {
     if (num.isNegative()) {
         out << '-';
     }
-    out << num._num;
+    out << num._toString();
     return out;
 }
 
@@ -757,26 +1138,245 @@ public:
 
     bool verify(const BigInt& m, const BigInt& r, const BigInt& h);
 
+    // Verifies many (m, r, h) triples together, result[i] tells whether triple i is valid
+    std::vector<bool> verifyBatch(const std::vector<std::tuple<BigInt, BigInt, BigInt>>& signatures);
+
 private:
     BigInt _p; // Prime modulus
     BigInt _g; // Generator
     BigInt _y; // Public key
+    std::mt19937_64 _rng; // Small random exponents for the batch test
+    int _batchable; // -1 until checked, then whether p is a safe prime the batch test is sound for
+    int _symbolG, _symbolY; // Legendre symbols (g / p), (y / p)
+
+    bool _isProbablePrime(const BigInt& n, int rounds);
+    bool _canBatch();
+    bool _verifyAggregate(const std::vector<std::tuple<BigInt, BigInt, BigInt>>& signatures,
+        const std::vector<size_t>& indices);
+    void _bisect(const std::vector<std::tuple<BigInt, BigInt, BigInt>>& signatures,
+        const std::vector<size_t>& indices, std::vector<bool>& result);
 };
 
 ElGamalVerifier::ElGamalVerifier(const BigInt& p, const BigInt& g, const BigInt& y)
-    : _p(p), _g(g), _y(y) {}
+    : _p(p), _g(g), _y(y), _rng(std::random_device()()), _batchable(-1), _symbolG(0), _symbolY(0) {}
 
 bool ElGamalVerifier::verify(const BigInt& m, const BigInt& r, const BigInt& h) {
-    // Calculate v1 = g^h mod p
-    BigInt v1 = BigInt::modularPower(_g, h, _p);
+    // Calculate v1 = g^m mod p
+    BigInt v1 = BigInt::modularPower(_g, m, _p);
 
-    // Calculate v2 = (y^r * r^h) mod p
-    BigInt v2 = (BigInt::modularPower(_y, r, _p) * BigInt::modularPower(r, h, _p)) % _p;
+    // Calculate v2 = (y^r * r^h) mod p in one interleaved pass
+    BigInt v2 = BigInt::multiExp({ _y, r }, { r, h }, _p);
 
     // Check if v1 is equal to v2
     return v1 == v2;
 }
 
+/**
+ * @brief Miller-Rabin with random bases, n > 3 odd.
+ *
+ * @return false if n is composite, true if n passed every round
+ */
+bool ElGamalVerifier::_isProbablePrime(const BigInt& n, int rounds) {
+    const BigInt one("1");
+    const BigInt nMinusOne = n - one;
+
+    // n - 1 = d * 2^s
+    BigInt d = nMinusOne;
+    int s = 0;
+    while (d % "2" == "0") {
+        d /= "2";
+        ++s;
+    }
+
+    const BigInt span = n - "3";
+    std::ostringstream decimal;
+    decimal << n;
+    // Thêm 20 chữ số để phép lấy dư cho span gần như phân bố đều
+    const size_t length = decimal.str().length() + 20;
+
+    for (int i = 0; i < rounds; ++i) {
+        // Cơ số ngẫu nhiên trong [2, n - 2]
+        std::string digits;
+        while (digits.length() < length) {
+            digits += std::to_string(_rng());
+        }
+        const BigInt a = BigInt(digits) % span + "2";
+
+        BigInt x = BigInt::modularPower(a, d, n);
+        if (x == one || x == nMinusOne) {
+            continue;
+        }
+
+        bool composite = true;
+        for (int j = 1; j < s && composite; ++j) {
+            x = BigInt::modularMultiplication(x, x, n);
+            composite = x != nMinusOne;
+        }
+        if (composite) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Whether the batch test is sound for this key, computed once per verifier.
+ *
+ * The aggregate check only catches every forgery in a group of prime order, see _verifyAggregate.
+ * That holds when p = 2q + 1 is a safe prime with q above 2^64, the size of the random d_i:
+ * a triple whose sides have equal Legendre symbols has its discrepancy in the squares mod p,
+ * which form the subgroup of order q. Any other p is verified one signature at a time.
+ */
+bool ElGamalVerifier::_canBatch() {
+    if (_batchable < 0) {
+        const BigInt q = std::get<0>((_p - "1") / "2");
+        _batchable = q > "18446744073709551616"
+            && _isProbablePrime(_p, 32) && _isProbablePrime(q, 32);
+
+        if (_batchable) {
+            _symbolG = BigInt::jacobi(_g, _p);
+            _symbolY = BigInt::jacobi(_y, _p);
+            // g hoặc y chia hết cho p thì không có ký hiệu Legendre để so sánh
+            _batchable = _symbolG != 0 && _symbolY != 0;
+        }
+    }
+    return _batchable;
+}
+
+/**
+ * @brief Small exponent batch test (Bellare, Garay, Rabin 1998) over the given triples.
+ *
+ * With a random 64-bit d_i per signature, every g^m_i = y^r_i * r_i^h_i holds with
+ * probability 1 - 2^-64 iff
+ *     g^(sum d_i m_i) * y^-(sum d_i r_i) * prod r_i^-(d_i h_i) = 1 (mod p),
+ * exponents taken mod p - 1. This needs every discrepancy g^m_i / (y^r_i * r_i^h_i)
+ * to lie in a group of prime order above 2^64: Z_p* itself has even order p - 1, so two
+ * discrepancies of -1 would cancel. Callers only pass triples whose two sides have the same
+ * Legendre symbol for a safe prime p = 2q + 1, which puts the discrepancies in the squares,
+ * the subgroup of prime order q. The whole product is a single multiExp, so g and y are
+ * raised once for the batch and all bases share one chain of squarings.
+ *
+ * @return true if the batch passes
+ */
+bool ElGamalVerifier::_verifyAggregate(const std::vector<std::tuple<BigInt, BigInt, BigInt>>& signatures,
+    const std::vector<size_t>& indices) {
+    const BigInt order = _p - BigInt("1");
+
+    std::vector<BigInt> bases, exponents;
+    bases.reserve(indices.size() + 2);
+    exponents.reserve(indices.size() + 2);
+
+    BigInt sumM, sumR;
+    for (size_t i : indices) {
+        const BigInt& m = std::get<0>(signatures[i]);
+        const BigInt& r = std::get<1>(signatures[i]);
+        const BigInt& h = std::get<2>(signatures[i]);
+        const BigInt d(std::to_string(_rng()));
+
+        sumM += d * m;
+        sumR += d * r;
+
+        // r_i^-(d_i h_i) = r_i^((p - 1) - (d_i h_i mod p - 1))
+        bases.push_back(r);
+        exponents.push_back(order - (d * h) % order);
+    }
+
+    bases.push_back(_g);
+    exponents.push_back(sumM % order);
+    bases.push_back(_y);
+    exponents.push_back(order - sumR % order);
+
+    return BigInt::multiExp(bases, exponents, _p) == BigInt("1");
+}
+
+/**
+ * @brief Find the invalid triples of a batch whose aggregate check failed by splitting it in halves.
+ *
+ * Valid signatures pass the aggregate check for any choice of d_i, so a failing group always
+ * holds an invalid one: a failing single triple is invalid, and when the left half passes
+ * the right half is known to fail without checking it again.
+ */
+void ElGamalVerifier::_bisect(const std::vector<std::tuple<BigInt, BigInt, BigInt>>& signatures,
+    const std::vector<size_t>& indices, std::vector<bool>& result) {
+    if (indices.size() == 1) {
+        result[indices[0]] = false;
+        return;
+    }
+
+    const size_t half = indices.size() / 2;
+    const std::vector<size_t> left(indices.begin(), indices.begin() + half);
+    const std::vector<size_t> right(indices.begin() + half, indices.end());
+
+    if (_verifyAggregate(signatures, left)) {
+        for (size_t i : left) {
+            result[i] = true;
+        }
+        _bisect(signatures, right, result);
+        return;
+    }
+
+    _bisect(signatures, left, result);
+    if (_verifyAggregate(signatures, right)) {
+        for (size_t i : right) {
+            result[i] = true;
+        }
+    }
+    else {
+        _bisect(signatures, right, result);
+    }
+}
+
+std::vector<bool> ElGamalVerifier::verifyBatch(const std::vector<std::tuple<BigInt, BigInt, BigInt>>& signatures) {
+    std::vector<bool> result(signatures.size(), false);
+
+    // r phải thuộc [1, p - 1], nếu không chữ ký sai ngay mà không cần tính
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i < signatures.size(); ++i) {
+        const BigInt& r = std::get<1>(signatures[i]);
+        if (!r.isNegative() && r != BigInt() && r < _p) {
+            candidates.push_back(i);
+        }
+    }
+
+    if (!_canBatch()) {
+        for (size_t i : candidates) {
+            result[i] = verify(std::get<0>(signatures[i]), std::get<1>(signatures[i]), std::get<2>(signatures[i]));
+        }
+        return result;
+    }
+
+    // Ký hiệu Legendre của g^m và y^r * r^h phải bằng nhau, chữ ký lệch dấu bị loại trước khi gộp
+    std::vector<size_t> squares;
+    for (size_t i : candidates) {
+        const BigInt& m = std::get<0>(signatures[i]);
+        const BigInt& r = std::get<1>(signatures[i]);
+        const BigInt& h = std::get<2>(signatures[i]);
+
+        int lhs = _symbolG == -1 && m % "2" != "0" ? -1 : 1;
+        int rhs = _symbolY == -1 && r % "2" != "0" ? -1 : 1;
+        if (h % "2" != "0" && BigInt::jacobi(r, _p) == -1) {
+            rhs = -rhs;
+        }
+        if (lhs == rhs) {
+            squares.push_back(i);
+        }
+    }
+
+    if (squares.empty()) {
+        return result;
+    }
+
+    if (_verifyAggregate(signatures, squares)) {
+        for (size_t i : squares) {
+            result[i] = true;
+        }
+    }
+    else {
+        _bisect(signatures, squares, result);
+    }
+    return result;
+}
+
 int main(int argc, char* argv[]) {
     if (argc != 3) {
         std::cerr << "Usage: " << argv[0] << " <input_file> <output_file>\n";
@@ -797,15 +1397,20 @@ int main(int argc, char* argv[]) {
     // Create ElGamalVerifier with public key (p, g, y)
     ElGamalVerifier verifier(p, g, y);
 
-    // Read message (m) and signature (r, h)
+    // Read message (m) and signature (r, h), one triple or a whole batch
+    std::vector<std::tuple<BigInt, BigInt, BigInt>> signatures;
     BigInt m, r, h;
-    inputFile >> m >> r >> h;
+    while (inputFile >> m >> r >> h) {
+        signatures.emplace_back(m, r, h);
+    }
 
     // Close input file
     inputFile.close();
 
-    // Verify the signature
-    bool isValid = verifier.verify(m, r, h);
+    // Verify the signatures
+    std::vector<bool> isValid = signatures.size() == 1
+        ? std::vector<bool>{ verifier.verify(std::get<0>(signatures[0]), std::get<1>(signatures[0]), std::get<2>(signatures[0])) }
+        : verifier.verifyBatch(signatures);
 
     // Write output file
     std::ofstream outputFile(argv[2]);
@@ -814,8 +1419,10 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Write result to output file
-    outputFile << (isValid ? 1 : 0) << std::endl;
+    // Write results to output file, one line per signature
+    for (bool valid : isValid) {
+        outputFile << (valid ? 1 : 0) << '\n';
+    }
 
     // Close output file
     outputFile.close();
@@ -1,30 +1,115 @@
 ﻿#include <iostream>
 #include <fstream>
+#include <string>
 #include <vector>
+#include <atomic>
+
+// Bộ số lớn dùng chung với đồ án RSA: hex little-endian, lũy thừa 128 bit cho p
+// vừa một từ máy và Montgomery cho p lớn hơn
+#include "../../Bao_cao_cuoi_ki/nmmhmm-1-master/BigInt.h"
+#include "../../Bao_cao_cuoi_ki/nmmhmm-1-master/ThreadPool.h"
 
 // Hàm kiểm tra xem g có phải là căn nguyên thủy modulo p không
-bool isPrimitiveRoot(unsigned long long g, unsigned long long p, const std::vector<int>& factors) {
+// g là căn nguyên thủy khi g^((p-1)/q) != 1 với mọi ước nguyên tố q của p - 1
+bool isPrimitiveRoot(const BigInt& g, const BigInt& p, const std::vector<BigInt>& factors) {
     if (g <= 1 || g >= p) {
         return false;
     }
 
-    for (int factor : factors) {
-        unsigned long long result = 1;
-        for (int i = 0; i < (p - 1) / factor; ++i) {
-            result = (result * g) % p;
+    const BigInt order = p - 1;
+
+    // p vừa một từ máy (hoặc chẵn): lũy thừa trực tiếp, không đáng chia luồng
+    if (p.bitLength() <= 64 || !p[0]) {
+        for (const BigInt& factor : factors) {
+            if (BigInt::powMod(g, order / factor, p) == 1) {
+                return false;
+            }
         }
+        return true;
+    }
+
+    // Mỗi ước một luồng, ước đầu tiên cho kết quả 1 thì hủy các lũy thừa còn lại
+    const BigInt::Montgomery mont(p);
+    const BigInt gM = mont.toMont(g);
+    const BigInt one = mont.one();
+    std::atomic<bool> failed{ false };
+
+    TaskGroup group;
+    for (const BigInt& factor : factors) {
+        group.run([&, factor]() {
+            if (mont.exp(gM, order / factor, BigInt::SLIDING_WINDOW, &group.cancelled) == one) {
+                failed = true;
+                group.cancel();
+            }
+        });
+    }
+    group.wait();
 
-        if (result == 1) {
-            return false;
+    return !failed;
+}
+
+// Tìm căn nguyên thủy nhỏ nhất modulo p (p nguyên tố, factors là các ước nguyên tố của p - 1)
+// Các ứng viên được thử theo lô: mọi cặp (ứng viên, ước) của một lô chạy song song,
+// một ứng viên bị loại thì các lũy thừa còn lại của nó dừng ngay
+BigInt findPrimitiveRoot(const BigInt& p, const std::vector<BigInt>& factors) {
+    if (p.bitLength() <= 64 || !p[0]) {
+        for (BigInt g = 2; g < p; g = g + 1) {
+            if (isPrimitiveRoot(g, p, factors)) {
+                return g;
+            }
         }
+        return 0;
+    }
+
+    const BigInt order = p - 1;
+    std::vector<BigInt> exponents;
+    for (const BigInt& factor : factors) {
+        exponents.push_back(order / factor);
     }
 
-    return true;
+    const BigInt::Montgomery mont(p);
+    const BigInt one = mont.one();
+    const size_t batch = 2 * ThreadPool::global().size();
+
+    for (BigInt first = 2; first < p; first = first + (long long)batch) {
+        std::vector<BigInt> candidates, candidatesM;
+        for (BigInt g = first; g < p && candidates.size() < batch; g = g + 1) {
+            candidates.push_back(g);
+            candidatesM.push_back(mont.toMont(g));
+        }
+
+        // rejected[i] là cờ dừng của ứng viên i (atomic nên các luồng không ghi đè nhau)
+        std::vector<std::atomic<bool>> rejected(candidates.size());
+        {
+            TaskGroup group;
+            for (size_t e = 0; e < exponents.size(); ++e) {
+                for (size_t i = 0; i < candidates.size(); ++i) {
+                    group.run([&, e, i]() {
+                        if (rejected[i]) return;
+                        if (mont.exp(candidatesM[i], exponents[e], BigInt::SLIDING_WINDOW, &rejected[i]) == one) {
+                            rejected[i] = true;
+                        }
+                    });
+                }
+            }
+            group.wait();
+        }
+
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (!rejected[i]) {
+                return candidates[i];
+            }
+        }
+    }
+
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " input_file output_file" << std::endl;
+    // Với --find, dòng g bị bỏ qua và chương trình ghi ra căn nguyên thủy nhỏ nhất
+    const bool find = argc == 4 && std::string(argv[3]) == "--find";
+    if (argc != 3 && !find) {
+        std::cerr << "Usage: " << argv[0] << " input_file output_file [--find]" << std::endl;
         return 1;
     }
 
@@ -36,18 +121,34 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    unsigned long long p, n, g;
-    input >> p >> n;
+    // Mọi số trong tệp đều là hex little-endian
+    std::string token;
+    input >> token;
+    BigInt p(token);
+    input >> token;
+    long long n = BigInt(token).toLongLong();
 
-    std::vector<int> factors(n);
-    for (int i = 0; i < n; ++i) {
-        input >> factors[i];
+    std::vector<BigInt> factors;
+    for (long long i = 0; i < n && input >> token; ++i) {
+        factors.push_back(BigInt(token));
+    }
+    for (const BigInt& factor : factors) {
+        if (factor <= 1) {
+            std::cerr << "Invalid factor." << std::endl;
+            return 1;
+        }
     }
 
-    input >> g;
+    if (find) {
+        output << findPrimitiveRoot(p, factors).toHexString() << std::endl;
+    }
+    else {
+        input >> token;
+        BigInt g(token);
 
-    int result = isPrimitiveRoot(g, p, factors) ? 1 : 0;
-    output << result << std::endl;
+        int result = isPrimitiveRoot(g, p, factors) ? 1 : 0;
+        output << result << std::endl;
+    }
 
     input.close();
     output.close();
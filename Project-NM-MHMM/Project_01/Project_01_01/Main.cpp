@@ -1,147 +1,97 @@
-#pragma comment(linker, "/STACK:5000000")
 #include<iostream>
 #include<string>
 #include<vector>
+#include<cstdint>
 #include<cstdlib>
 #include<ctime>
 #include<fstream>
 using namespace std;
 
-const vector<int> Bit0 = { 0 };
-const vector<int> Bit1 = { 1 };
-const vector<int> Bit2 = { 0,1 };
+/*
+So nguyen lon duoi dang Binary nen: moi phan tu chua 32 bit, phan tu thap nhat dung truoc.
+So 0 la vector rong, phan tu cao nhat luon khac 0.
+Cac ham nhan tham so bang tham chieu hang va tra ket qua qua tham so ra,
+nen bo nho cua ket qua duoc dung lai giua cac lan goi.
+*/
+typedef vector<uint32_t> BigNum;
+
+const BigNum Num0 = {};
+const BigNum Num1 = { 1 };
+const BigNum Num2 = { 2 };
 
 /*
-Chuyen chuoi Hex sang chuoi Binary
-Input:	1 string ( chuoi Hex ) ( strHex ).
-Output: 1 vector ( chuoi Binary ).
+Bo cac phan tu 0 o dau cao cua so nguyen lon
+Input:	1 BigNum ( num ).
+Output:	Ket qua khong tra truc tiep ve ma thong qua bien ( num ).
 */
-vector<int> convertHexToBinary(string strHex) 
+void trimBigNum(BigNum& num)
 {
-	vector<int> arrBit;
-	for (int i = 0; i < strHex.length(); i++)
+	while (!num.empty() && num.back() == 0)
+	{
+		num.pop_back();
+	}
+}
+
+/*
+Dem so bit cua so nguyen lon ( khong tinh cac bit 0 o dau cao )
+Input:	1 BigNum ( num ).
+Output:	1 so nguyen.
+*/
+int bitLengthBigNum(const BigNum& num)
+{
+	if (num.empty()) return 0;
+	int len = 32 * (num.size() - 1);
+	for (uint32_t top = num.back(); top != 0; top >>= 1)
+	{
+		len++;
+	}
+	return len;
+}
+
+/*
+Dich phai so nguyen lon ( chia cho 2 ^ bits )
+Input:	1 BigNum ( num ), 1 so nguyen ( bits ).
+Output:	Ket qua khong tra truc tiep ve ma thong qua bien ( num ).
+*/
+void shiftRightBigNum(BigNum& num, int bits)
+{
+	int limbs = bits / 32;
+	bits %= 32;
+	if (limbs >= num.size())
+	{
+		num.clear(); return;
+	}
+	num.erase(num.begin(), num.begin() + limbs);
+	if (bits != 0)
 	{
-		switch (strHex[i])
+		for (int i = 0; i + 1 < num.size(); i++)
 		{
-		case '0': {
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			break;
-		}
-		case '1': {
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			break;
-		}
-		case '2': {
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			break;
-		}
-		case '3': {
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			break;
-		}
-		case '4': {
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			break;
-		}
-		case '5': {
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			break;
-		}
-		case '6': {
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			break;
-		}
-		case '7': {
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			break;
-		}
-		case '8': {
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			break;
-		}
-		case '9': {
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			break;
-		}
-		case 'A': {
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			break;
-		}
-		case 'B': {
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			break;
-		}
-		case 'C': {
-			arrBit.push_back(0);
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			break;
-		}
-		case 'D': {
-			arrBit.push_back(1);
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			break;
-		}
-		case 'E': {
-			arrBit.push_back(0);
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			break;
-		}
-		case 'F': {
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			arrBit.push_back(1);
-			break;
-		}
+			num[i] = (num[i] >> bits) | (num[i + 1] << (32 - bits));
 		}
+		num.back() >>= bits;
 	}
-	while (arrBit[arrBit.size() - 1] == 0 && arrBit.size() > 1)
+	trimBigNum(num);
+}
+
+/*
+Chuyen chuoi Hex sang chuoi Binary
+Input:	1 string ( chuoi Hex ) ( strHex ).
+Output: 1 BigNum ( chuoi Binary ).
+*/
+BigNum convertHexToBinary(const string& strHex)
+{
+	BigNum num((strHex.length() + 7) / 8, 0);
+	for (int i = 0; i < strHex.length(); i++)
 	{
-		arrBit.pop_back();
+		uint32_t digit;
+		if (strHex[i] >= '0' && strHex[i] <= '9') digit = strHex[i] - '0';
+		else if (strHex[i] >= 'A' && strHex[i] <= 'F') digit = strHex[i] - 'A' + 10;
+		else if (strHex[i] >= 'a' && strHex[i] <= 'f') digit = strHex[i] - 'a' + 10;
+		else continue;
+		num[i / 8] |= digit << (4 * (i % 8));
 	}
-	return arrBit;
+	trimBigNum(num);
+	return num;
 }
 
 /*
@@ -153,7 +103,7 @@ Output:	1 trong 3 gia tri ( 0, 1, 2 ).
 		*	2:	Chuoi Hex la 0 hoac la 1.
 		*	0:	Chuoi Hex khong thuoc cac truong hop tren.
 */
-int isNumber2or3(string strHex) 
+int isNumber2or3(const string& strHex)
 {
 	if (strHex.length() != 1) return 0;
 	if (strHex == "0" || strHex == "1") return 2;
@@ -165,10 +115,10 @@ int isNumber2or3(string strHex)
 Kiem tra chuoi Hex co phai la so chan khong ?
 Input:	1 string ( chuoi Hex ) ( strHex ).
 Output:	True hoac False.
-		*	True:	Chuoi Hex la 1 so chan. 
-		*	False:	Chuoi Hex la 1 so le. 
+		*	True:	Chuoi Hex la 1 so chan.
+		*	False:	Chuoi Hex la 1 so le.
 */
-bool isEvenNumber(string strHex) 
+bool isEvenNumber(const string& strHex)
 {
 	char tempStrHex = strHex[0];
 	if (tempStrHex == '0' || tempStrHex == '2' || tempStrHex == '4' || tempStrHex == '6'
@@ -179,24 +129,23 @@ bool isEvenNumber(string strHex)
 
 /*
 So sanh 2 so nguyen lon duoi dang Binary
-Input:	1 vector ( chuoi Binary ) ( arrBit1 ), 1 vector ( chuoi Binary ) ( arrBit2 ).
-Output:	1 vector ( chuoi Binary ).
-Output:	1 trong 3 gia tri ( 0, 1, 2 ).
+Input:	1 BigNum ( chuoi Binary ) ( num1 ), 1 BigNum ( chuoi Binary ) ( num2 ).
+Output:	1 trong 3 gia tri ( 0, 1, -1 ).
 		*	1  :	a > b.
 		*	-1 :	a < b.
 		*	0  :	a = b.
 */
-int compareBigNum(vector<int> arrBit1, vector<int> arrBit2)
+int compareBigNum(const BigNum& num1, const BigNum& num2)
 {
-	if (arrBit1.size() != arrBit2.size())
+	if (num1.size() != num2.size())
 	{
-		if (arrBit1.size() > arrBit2.size()) return 1;
+		if (num1.size() > num2.size()) return 1;
 		else return -1;
 	}
-	for (int i = arrBit1.size() - 1; i >= 0; i--)
+	for (int i = num1.size() - 1; i >= 0; i--)
 	{
-		if (arrBit1[i] > arrBit2[i]) return 1;
-		if (arrBit1[i] < arrBit2[i]) return -1;
+		if (num1[i] > num2[i]) return 1;
+		if (num1[i] < num2[i]) return -1;
 	}
 	return 0;
 }
@@ -205,302 +154,329 @@ int compareBigNum(vector<int> arrBit1, vector<int> arrBit2)
 Tim s va r trong:
 n - 1 = ( 2 ^ s ) * r. Voi r la 1 so le.
 
-Input:	1 vector ( chuoi Binary ) ( arrBitN ), 1 so nguyen ( s )
-		, 1 vector ( chuoi Binary ) ( arrBitR ).
-Output:	Ket qua khong tra truc tiep ve ma thong qua 2 bien ( s ) va ( arrBitR ).
+Input:	1 BigNum ( chuoi Binary ) ( numN ), 1 so nguyen ( s )
+		, 1 BigNum ( chuoi Binary ) ( numR ).
+Output:	Ket qua khong tra truc tiep ve ma thong qua 2 bien ( s ) va ( numR ).
 */
-void findSandR(vector<int> arrBitN, int& s, vector<int>& arrBitR)
+void findSandR(const BigNum& numN, int& s, BigNum& numR)
 {
 	s = 0;
-	vector<int> tempArrBit = arrBitN;
-	tempArrBit[0] = 0;
-	while (tempArrBit[0] == 0) 
+	numR = numN;
+	if (!numR.empty()) numR[0] &= ~1u;
+	trimBigNum(numR);
+	if (numR.empty()) return;
+
+	int limb = 0;
+	while (numR[limb] == 0)
+	{
+		limb++;
+	}
+	s = 32 * limb;
+	for (uint32_t low = numR[limb]; (low & 1) == 0; low >>= 1)
 	{
 		s++;
-		tempArrBit.erase(tempArrBit.begin());
 	}
-	arrBitR = tempArrBit;
+	shiftRightBigNum(numR, s);
 }
 
 /*
 Cong 2 so nguyen lon duoi dang Binary
-Input:	1 vector ( chuoi Binary ) ( arrBit1 ), 1 vector ( chuoi Binary ) ( arrBit2 ).
-Output:	1 vector ( chuoi Binary ).
+Input:	1 BigNum ( chuoi Binary ) ( num1 ), 1 BigNum ( chuoi Binary ) ( num2 )
+		, 1 BigNum ( chuoi Binary ) ( numResult ).
+Output:	Ket qua khong tra truc tiep ve ma thong qua bien ( numResult ).
+		*	numResult duoc phep trung voi num1 hoac num2.
 */
-vector<int> addBigNum(vector<int> arrBit1, vector<int> arrBit2) 
+void addBigNum(const BigNum& num1, const BigNum& num2, BigNum& numResult)
 {
-	vector<int> arrBitResult;
-	int carry = 0;
-	if (arrBit1.size() == 0) return arrBit2;
-	if (arrBit2.size() == 0) return arrBit1;
+	const size_t size1 = num1.size();
+	const size_t size2 = num2.size();
+	const size_t size = size1 > size2 ? size1 : size2;
+	uint64_t carry = 0;
 
-	while (arrBit1.size() != arrBit2.size())
-	{
-		if (arrBit1.size() > arrBit2.size()) arrBit2.push_back(0);
-		else arrBit1.push_back(0);
-	}
-	for (int i = 0; i < arrBit1.size(); i++)
+	numResult.resize(size);
+	for (size_t i = 0; i < size; i++)
 	{
-		arrBitResult.push_back((arrBit1[i] + arrBit2[i] + carry) % 2);
-		if (arrBit1[i] + arrBit2[i] + carry >= 2) carry = 1;
-		else carry = 0;
+		carry += (uint64_t)(i < size1 ? num1[i] : 0) + (i < size2 ? num2[i] : 0);
+		numResult[i] = (uint32_t)carry;
+		carry >>= 32;
 	}
-	if (carry == 1) arrBitResult.push_back(1);
-	while (arrBitResult[arrBitResult.size() - 1] == 0 && arrBitResult.size() > 1)
-	{
-		arrBitResult.pop_back();
-	}
-	return arrBitResult;
+	if (carry != 0) numResult.push_back((uint32_t)carry);
 }
 
 /*
 Nhan 2 so nguyen lon duoi dang Binary
-Input:	1 vector ( chuoi Binary ) ( arrBit1 ), 1 vector ( chuoi Binary ) ( arrBit2 ).
-Output:	1 vector ( chuoi Binary ).
+Input:	1 BigNum ( chuoi Binary ) ( num1 ), 1 BigNum ( chuoi Binary ) ( num2 )
+		, 1 BigNum ( chuoi Binary ) ( numResult ).
+Output:	Ket qua khong tra truc tiep ve ma thong qua bien ( numResult ).
+		*	numResult duoc phep trung voi num1 hoac num2.
 */
-vector<int> mulBigNum(vector<int> arrBit1, vector<int> arrBit2)
+void mulBigNum(const BigNum& num1, const BigNum& num2, BigNum& numResult)
 {
-	vector<int> arrBitResult;
-	vector<int>	tempArrBit2 = arrBit2;
-
-	if (compareBigNum(Bit2,arrBit1)==0)
+	// Tich duoc tinh vao bo nho tam roi doi cho voi ket qua, lan goi sau dung lai bo nho cu
+	static BigNum product;
+	if (num1.empty() || num2.empty())
 	{
-		arrBit2.insert(arrBit2.begin(), 0);
-		return arrBit2;
-	}
-	else
-	{
-		if (compareBigNum(Bit2, arrBit2) == 0)
-		{
-			arrBit1.insert(arrBit1.begin(), 0);
-			return arrBit1;
-		}
+		numResult.clear(); return;
 	}
 
-	for (int i = 0; i < arrBit1.size(); i++)
+	product.assign(num1.size() + num2.size(), 0);
+	for (size_t i = 0; i < num1.size(); i++)
 	{
-		if (i != 0)
-		{
-			tempArrBit2.insert(tempArrBit2.begin(), 0);
-		}
-		if (arrBit1[i] == 1)
+		uint64_t carry = 0;
+		for (size_t j = 0; j < num2.size(); j++)
 		{
-			arrBitResult = addBigNum(arrBitResult, tempArrBit2);
+			carry += (uint64_t)num1[i] * num2[j] + product[i + j];
+			product[i + j] = (uint32_t)carry;
+			carry >>= 32;
 		}
+		product[i + num2.size()] = (uint32_t)carry;
 	}
-	return arrBitResult;
+	trimBigNum(product);
+	numResult.swap(product);
 }
 
 /*
-Tru 2 so nguyen lon duoi dang Binary
-Input:	1 vector ( chuoi Binary ) ( arrBit1 ), 1 vector ( chuoi Binary ) ( arrBit2 ).
-Output:	1 vector ( chuoi Binary ).
+Tru 2 so nguyen lon duoi dang Binary ( num1 >= num2 )
+Input:	1 BigNum ( chuoi Binary ) ( num1 ), 1 BigNum ( chuoi Binary ) ( num2 )
+		, 1 BigNum ( chuoi Binary ) ( numResult ).
+Output:	Ket qua khong tra truc tiep ve ma thong qua bien ( numResult ).
+		*	numResult duoc phep trung voi num1 hoac num2.
 */
-vector<int> subBigNum(vector<int> arrBit1, vector<int> arrBit2)
+void subBigNum(const BigNum& num1, const BigNum& num2, BigNum& numResult)
 {
-	vector<int> arrBitResult;
-	int carry = 0;
-	int tempCarry = 0;
-	while (arrBit1.size() != arrBit2.size())
-	{
-		if (arrBit1.size() > arrBit2.size()) arrBit2.push_back(0);
-		else arrBit1.push_back(0);
-	}
-	for (int i = 0; i < arrBit1.size(); i++)
-	{
-		if (arrBit1[i] >= arrBit2[i] + carry)
-		{
-			arrBitResult.push_back(arrBit1[i] - (arrBit2[i] + carry));
-			carry = 0;
-		}
-		else
-		{
-			if (arrBit1[i] - (arrBit2[i] + carry) == -1)
-			{
-				arrBitResult.push_back(1); carry = 1;
-			}
-			else 
-			{
-				arrBitResult.push_back(0); carry = 1;
-			}
-		}
-	}
-	while (arrBitResult[arrBitResult.size() - 1] == 0 && arrBitResult.size() > 1)
+	const size_t size1 = num1.size();
+	const size_t size2 = num2.size();
+	int64_t borrow = 0;
+
+	numResult.resize(size1);
+	for (size_t i = 0; i < size1; i++)
 	{
-		arrBitResult.pop_back();
+		int64_t diff = (int64_t)num1[i] - (i < size2 ? num2[i] : 0) - borrow;
+		borrow = diff < 0 ? 1 : 0;
+		numResult[i] = (uint32_t)diff;
 	}
-	return arrBitResult;
+	trimBigNum(numResult);
 }
 
 /*
-Chia 2 so nguyen lon duoi dang Binary
-Input:	1 vector ( chuoi Binary ) ( arrBit1 ), 1 vector ( chuoi Binary ) ( arrBit2 )
-		, 1 vector ( chuoi Binary ) ( arrBit3 ), 1 vector ( chuoi Binary ) ( arrBit4 ).
-Output:	Ket qua khong tra truc tiep ve ma thong qua 2 bien ( arrBit3 ) va ( arrBit4 ).
-		*	arrBit3: Phan nguyen.
-		*	arrBit4: Phan du.
+Chia 2 so nguyen lon duoi dang Binary ( thuat toan D cua Knuth )
+Input:	1 BigNum ( chuoi Binary ) ( num1 ), 1 BigNum ( chuoi Binary ) ( num2 )
+		, 1 BigNum ( chuoi Binary ) ( num3 ), 1 BigNum ( chuoi Binary ) ( num4 ).
+Output:	Ket qua khong tra truc tiep ve ma thong qua 2 bien ( num3 ) va ( num4 ).
+		*	num3: Phan nguyen.
+		*	num4: Phan du.
+		*	num2 = 0: num3 = 0, num4 = num1.
 */
-void divBigNum(vector<int> arrBit1, vector<int> arrBit2
-	, vector<int>& arrBit3, vector<int>& arrBit4)
+void divBigNum(const BigNum& num1, const BigNum& num2
+	, BigNum& num3, BigNum& num4)
 {
-	arrBit3.clear();
-	arrBit4.clear();
-	vector<int> tempArrBit1 = arrBit1;
-	vector<int> tempArrBit2 = arrBit2;
-	if (compareBigNum(tempArrBit1, tempArrBit2) == -1)
+	static BigNum u, v, quotient;
+	if (num2.empty() || compareBigNum(num1, num2) == -1)
 	{
-		arrBit3 = Bit0;
-		arrBit4 = tempArrBit1;
+		num4 = num1;
+		num3.clear();
 		return;
 	}
-	if (compareBigNum(arrBit2, Bit2) == 0)
+
+	if (num2.size() == 1)
 	{
-		if (tempArrBit1[0] == 0)
+		uint64_t rest = 0;
+		quotient.resize(num1.size());
+		for (int i = num1.size() - 1; i >= 0; i--)
 		{
-			tempArrBit1.erase(tempArrBit1.begin());
-			arrBit3 = tempArrBit1;
-			arrBit4 = Bit0;
-			return;
-		}
-		else
-		{
-			tempArrBit1.erase(tempArrBit1.begin());
-			arrBit3 = tempArrBit1;
-			arrBit4 = Bit1;
-			return;
+			rest = (rest << 32) | num1[i];
+			quotient[i] = (uint32_t)(rest / num2[0]);
+			rest %= num2[0];
 		}
+		trimBigNum(quotient);
+		num3.swap(quotient);
+		num4.clear();
+		if (rest != 0) num4.push_back((uint32_t)rest);
+		return;
+	}
+
+	// Chuan hoa: dich trai de bit cao nhat cua so chia bang 1
+	int shift = 0;
+	while ((num2.back() << shift & 0x80000000u) == 0)
+	{
+		shift++;
 	}
+	const int n = num2.size();
+	const int m = num1.size() - n;
 
-	while (compareBigNum(tempArrBit1, tempArrBit2) != -1)
+	v.resize(n);
+	for (int i = n - 1; i > 0; i--)
 	{
-		tempArrBit2.insert(tempArrBit2.begin(), 0);
+		v[i] = shift ? (num2[i] << shift) | (num2[i - 1] >> (32 - shift)) : num2[i];
 	}
-	tempArrBit2.erase(tempArrBit2.begin());
-	arrBit3.push_back(1);
-	tempArrBit1 = subBigNum(tempArrBit1, tempArrBit2);
+	v[0] = num2[0] << shift;
 
-	while (tempArrBit2.size() > arrBit2.size())
+	u.resize(num1.size() + 1);
+	u[num1.size()] = shift ? num1.back() >> (32 - shift) : 0;
+	for (int i = num1.size() - 1; i > 0; i--)
 	{
-		tempArrBit2.erase(tempArrBit2.begin());
-		if (compareBigNum(tempArrBit1, tempArrBit2) == -1)
+		u[i] = shift ? (num1[i] << shift) | (num1[i - 1] >> (32 - shift)) : num1[i];
+	}
+	u[0] = num1[0] << shift;
+
+	quotient.assign(m + 1, 0);
+	for (int j = m; j >= 0; j--)
+	{
+		// Uoc luong chu so thuong tu 2 chu so cao, sai lech toi da 2
+		uint64_t top = ((uint64_t)u[j + n] << 32) | u[j + n - 1];
+		uint64_t qhat = top / v[n - 1];
+		uint64_t rhat = top % v[n - 1];
+		while (qhat > 0xFFFFFFFFu || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2]))
 		{
-			arrBit3.insert(arrBit3.begin(), 0);
+			qhat--;
+			rhat += v[n - 1];
+			if (rhat > 0xFFFFFFFFu) break;
 		}
-		else
+
+		// u = u - qhat * v * BASE^j
+		int64_t borrow = 0;
+		int64_t diff;
+		for (int i = 0; i < n; i++)
+		{
+			uint64_t p = qhat * v[i];
+			diff = (int64_t)u[i + j] - borrow - (int64_t)(p & 0xFFFFFFFFu);
+			u[i + j] = (uint32_t)diff;
+			borrow = (int64_t)(p >> 32) - (diff >> 32);
+		}
+		diff = (int64_t)u[j + n] - borrow;
+		u[j + n] = (uint32_t)diff;
+
+		// qhat lon hon 1: cong lai so chia
+		if (diff < 0)
 		{
-			arrBit3.insert(arrBit3.begin(), 1);
-			tempArrBit1 = subBigNum(tempArrBit1, tempArrBit2);
+			qhat--;
+			uint64_t carry = 0;
+			for (int i = 0; i < n; i++)
+			{
+				carry += (uint64_t)u[i + j] + v[i];
+				u[i + j] = (uint32_t)carry;
+				carry >>= 32;
+			}
+			u[j + n] += (uint32_t)carry;
 		}
+		quotient[j] = (uint32_t)qhat;
 	}
-	arrBit4 = tempArrBit1;
+
+	trimBigNum(quotient);
+	num3.swap(quotient);
+	num4.assign(u.begin(), u.begin() + n);
+	shiftRightBigNum(num4, shift);
+}
+
+/*
+Nhan 2 so nguyen lon theo modulo n
+	numResult = ( num1 * num2 ) mod numN.
+Input:	1 BigNum ( chuoi Binary ) ( num1 ), 1 BigNum ( chuoi Binary ) ( num2 )
+		, 1 BigNum ( chuoi Binary ) ( numN ), 1 BigNum ( chuoi Binary ) ( numResult ).
+Output:	Ket qua khong tra truc tiep ve ma thong qua bien ( numResult ).
+		*	numResult duoc phep trung voi num1 hoac num2.
+*/
+void mulModBigNum(const BigNum& num1, const BigNum& num2, const BigNum& numN, BigNum& numResult)
+{
+	static BigNum product, quotient;
+	mulBigNum(num1, num2, product);
+	divBigNum(product, numN, quotient, numResult);
 }
 
 /*
 Tao 1 so nguyen lon tu A den B
-Input:	1 vector ( chuoi Binary ) ( arrBit1 ), 1 vector ( chuoi Binary ) ( arrBit2 ).
-Output:	1 vector ( chuoi Binary ).
+Input:	1 BigNum ( chuoi Binary ) ( num1 ), 1 BigNum ( chuoi Binary ) ( num2 )
+		, 1 BigNum ( chuoi Binary ) ( numResult ).
+Output:	Ket qua khong tra truc tiep ve ma thong qua bien ( numResult ).
 */
-vector<int> genArrBit(vector<int>& arrBit1, vector<int>& arrBit2) 
+void genArrBit(const BigNum& num1, const BigNum& num2, BigNum& numResult)
 {
-	vector<int> arrBitResult;
-	srand(time(NULL));
+	// Chi khoi tao bo sinh mot lan, neu khong moi vong Miller-Rabin trong cung 1 giay deu lay cung 1 so a
+	static bool seeded = false;
+	if (!seeded)
+	{
+		srand(time(NULL)); seeded = true;
+	}
+	int len1 = bitLengthBigNum(num1);
+	int len2 = bitLengthBigNum(num2);
 	int len;
-	if (arrBit2.size() - arrBit1.size() == 0) len = arrBit1.size();
-	else len = (rand() % (arrBit2.size() - arrBit1.size())) + arrBit1.size();
+	if (len2 - len1 == 0) len = len1;
+	else len = (rand() % (len2 - len1)) + len1;
 	do
 	{
-		arrBitResult.clear();
+		numResult.assign((len + 31) / 32, 0);
 		for (int j = 0; j < len; j++)
 		{
-			arrBitResult.push_back(rand() % 2);
+			if (rand() % 2) numResult[j / 32] |= 1u << (j % 32);
 		}
-		while (arrBitResult[arrBitResult.size() - 1] == 0 && arrBitResult.size() > 1)
-		{
-			arrBitResult.pop_back();
-		}
-	} while (compareBigNum(arrBitResult, arrBit1) < 0 || compareBigNum(arrBitResult, arrBit2) > 0);
-	return arrBitResult;
+		trimBigNum(numResult);
+	} while (compareBigNum(numResult, num1) < 0 || compareBigNum(numResult, num2) > 0);
 }
 
 /*
 Nhan binh phuong co lap:
-	y = ( a ^ r ) mod n. Voi a < n
-Input:	1 vector ( chuoi Binary ) ( arrBitA ), 1 vector ( chuoi Binary ) ( arrBitN )
-		, 1 vector ( chuoi Binary ) ( arrBitR ), 1 vector ( chuoi Binary ) ( arrBitY ).
-Output:	Ket qua khong tra truc tiep ve ma thong qua bien ( arrBitY ).
+	y = ( a ^ r ) mod n.
+Input:	1 BigNum ( chuoi Binary ) ( numA ), 1 BigNum ( chuoi Binary ) ( numN )
+		, 1 BigNum ( chuoi Binary ) ( numR ), 1 BigNum ( chuoi Binary ) ( numY ).
+Output:	Ket qua khong tra truc tiep ve ma thong qua bien ( numY ).
+		*	numY duoc phep trung voi numA.
 */
-void iterativeSquaring(vector<int> arrBitA, vector<int> arrBitN
-	, vector<int> arrBitR, vector<int>& arrBitY)
+void iterativeSquaring(const BigNum& numA, const BigNum& numN
+	, const BigNum& numR, BigNum& numY)
 {
-	vector<int> tempArrBitA;
-	vector<int> tempArrBitB;
-	vector<int> tempArrBit;
-	if (compareBigNum(arrBitA, Bit0) == 0 || compareBigNum(arrBitA, arrBitR) == 0)
-	{
-		arrBitY = Bit0; return;
-	}
-	if (compareBigNum(arrBitR, Bit0) == 0)
+	static BigNum base, result, quotient;
+	if (numR.empty())
 	{
-		arrBitY = Bit1; return;
+		numY = Num1; return;
 	}
 
-	tempArrBitA = arrBitA;
-	tempArrBitB.push_back(1);
-
-	if (arrBitR[0] == 1) tempArrBitB = arrBitA;
-
-	for (int i = 1; i < arrBitR.size(); i++)
-	{
-		divBigNum(mulBigNum(tempArrBitA, tempArrBitA), arrBitN, tempArrBit, tempArrBitA);
-		if (arrBitR[i] == 1 && i != 0)
-			divBigNum(mulBigNum(tempArrBitA, tempArrBitB), arrBitN, tempArrBit, tempArrBitB);
-	}
-
-	while (tempArrBitB[tempArrBitB.size() - 1] == 0 && tempArrBitB.size() > 1)
+	// Duyet bit cua r tu cao xuong thap, moi tich deu rut gon theo n
+	divBigNum(numA, numN, quotient, base);
+	result = base;
+	for (int i = bitLengthBigNum(numR) - 2; i >= 0; i--)
 	{
-		tempArrBitB.pop_back();
+		mulModBigNum(result, result, numN, result);
+		if (numR[i / 32] >> (i % 32) & 1)
+			mulModBigNum(result, base, numN, result);
 	}
-	arrBitY = tempArrBitB;
+	numY.swap(result);
 }
 
 /*
 Kiem tra N co phai la so nguyen to khong ? ( voi so lan t nhat dinh )
-Input:	1 vector ( chuoi Binary ) ( arrBit1 ),  1 so nguyen ( t ).
+Input:	1 BigNum ( chuoi Binary ) ( numN ),  1 so nguyen ( t ).
 Output:	True hoac False.
-		*	True:	La so nguyen to. 
+		*	True:	La so nguyen to.
 		*	False:	Khong phai so nguyen to.
 */
-bool millerRabin(vector<int> arrBitN, int t)
+bool millerRabin(const BigNum& numN, int t)
 {
-	vector<int> tempArrBit;
-	vector<int> tempArrBitN;
-	vector<int> arrBitR;
+	BigNum numNSub1;
+	BigNum numNSub2;
+	BigNum numR;
+	BigNum numA;
+	BigNum numY;
 
-	vector<int> tempArrBit2 = Bit2;
-	vector<int> tempArrBitNSub2 = subBigNum(arrBitN, Bit2);
 	int s = 0;
-	tempArrBit.push_back(1);
-	tempArrBitN = subBigNum(arrBitN, tempArrBit);
-	findSandR(tempArrBitN, s, arrBitR);
+	subBigNum(numN, Num1, numNSub1);
+	subBigNum(numN, Num2, numNSub2);
+	findSandR(numNSub1, s, numR);
 	for (int i = 1; i <= t; i++)
 	{
-		vector<int> arrBitA;
-		vector<int> arrBitY;
-		arrBitA = genArrBit(tempArrBit2, tempArrBitNSub2);
-		iterativeSquaring(arrBitA, arrBitN, arrBitR, arrBitY);
-		if (compareBigNum(arrBitY, tempArrBit) != 0
-			&& compareBigNum(arrBitY, tempArrBitN) != 0)
+		genArrBit(Num2, numNSub2, numA);
+		iterativeSquaring(numA, numN, numR, numY);
+		if (compareBigNum(numY, Num1) != 0
+			&& compareBigNum(numY, numNSub1) != 0)
 		{
 			int j = 1;
-			vector<int> tempArrBit2 = Bit2;
-			while (j <= s - 1 && compareBigNum(arrBitY, tempArrBitN) != 0)
+			while (j <= s - 1 && compareBigNum(numY, numNSub1) != 0)
 			{
-				iterativeSquaring(arrBitY, arrBitN, tempArrBit2, arrBitY);
-				if (compareBigNum(arrBitY, tempArrBit) == 0) 
+				mulModBigNum(numY, numY, numN, numY);
+				if (compareBigNum(numY, Num1) == 0)
 					return false;
 				j++;
 			}
-			if (compareBigNum(arrBitY, tempArrBitN) != 0) 
+			if (compareBigNum(numY, numNSub1) != 0)
 				return false;
 		}
 	}
@@ -510,7 +486,7 @@ bool millerRabin(vector<int> arrBitN, int t)
 int main()
 {
 	string strHex;
-	vector<int> arrBit;
+	BigNum num;
 	int time = 1;
 
 	string nameFile = "test";
@@ -521,7 +497,7 @@ int main()
 	out.open(nameFile + ".out");
 
 	in >> strHex;
-	arrBit = convertHexToBinary(strHex);
+	num = convertHexToBinary(strHex);
 	if (isNumber2or3(strHex) == 1)
 	{
 		out << 1; return 0;
@@ -531,12 +507,13 @@ int main()
 		out << 0; return 0;
 	}
 
-	if (arrBit.size() <= 128) time = 10;
-	else if (arrBit.size() <= 256) time = 10;
-	else if (arrBit.size() <= 348) time = 3;
+	int len = bitLengthBigNum(num);
+	if (len <= 128) time = 10;
+	else if (len <= 256) time = 10;
+	else if (len <= 348) time = 3;
 	else time = 2;
 
-	if (millerRabin(arrBit, time))
+	if (millerRabin(num, time))
 	{
 		out << 1; return 0;
 	}
@@ -546,4 +523,4 @@ int main()
 	}
 
 	return 0;
-}
\ No newline at end of file
+}